@@ -0,0 +1,195 @@
+#ifndef BULLET_HELL_GAME_H
+#define BULLET_HELL_GAME_H
+
+#include "PlayDisplay.h"
+#include "GameRuntime.h"
+#include "Buttons.h"
+#include "ColumnCollide.h"
+#include "Sprites.h"
+#include <Fonts/FreeSans9pt7b.h>
+
+extern PlayDisplay display;
+
+// High-density Shooting mode: hundreds of live objects, collisions resolved
+// through column occupancy masks instead of all-pairs loops. Pools are kept
+// dense; dead entries are swap-removed after the collision pass.
+
+#define BH_MAX_BULLETS  192
+#define BH_MAX_ENEMIES  96
+#define BH_MAX_EBULLETS 384
+#define BH_TOP          10
+
+struct BhObj { int16_t x, y; int8_t dy; bool dead; };
+
+BhObj bhBullets[BH_MAX_BULLETS], bhEnemies[BH_MAX_ENEMIES], bhEBullets[BH_MAX_EBULLETS];
+int bhBulletCount, bhEnemyCount, bhEBulletCount;
+CollideLayer<BH_MAX_ENEMIES> bhEnemyLayer;
+CollideLayer<BH_MAX_EBULLETS> bhEBulletLayer;
+
+int bhPlayerY, bhScore, bhLives;
+uint32_t bhLastShot, bhLastSpawn, bhLastVolley, bhFrame;
+bool bhDead, bhOver;
+uint32_t bhDeadAt;
+
+void bhAdd(BhObj *pool, int &count, int max, int x, int y, int dy) {
+  if (count < max) pool[count++] = { (int16_t)x, (int16_t)y, (int8_t)dy, false };
+}
+
+void bhCompact(BhObj *pool, int &count) {
+  for (int i = 0; i < count;)
+    if (pool[i].dead) pool[i] = pool[--count];
+    else i++;
+}
+
+void bulletHellInit() {
+  bhBulletCount = bhEnemyCount = bhEBulletCount = 0;
+  bhPlayerY = 18;
+  bhScore = 0;
+  bhLives = 5;
+  bhLastShot = bhLastSpawn = bhLastVolley = bhFrame = 0;
+  bhDead = bhOver = false;
+  clearButtonEvents();
+}
+
+void bhSpawn() {
+  int n = 1 + bhScore / 40;  // ramps up with score
+  for (int i = 0; i < n; i++) bhAdd(bhEnemies, bhEnemyCount, BH_MAX_ENEMIES, 124, gameRandom(BH_TOP, 28), 0);
+}
+
+void bhMove() {
+  PROF_SCOPE(PROF_MOVE);
+  bhFrame++;
+  for (int i = 0; i < bhBulletCount; i++) {
+    BhObj &b = bhBullets[i];
+    b.x += 3;
+    if (bhFrame % 2 == 0) b.y += b.dy;
+    if (b.x >= 128 || b.y < BH_TOP || b.y > 31) b.dead = true;
+  }
+  for (int i = 0; i < bhEnemyCount; i++)
+    if (--bhEnemies[i].x < -4) bhEnemies[i].dead = true;
+  for (int i = 0; i < bhEBulletCount; i++) {
+    BhObj &eb = bhEBullets[i];
+    eb.x -= 2;
+    if (bhFrame % 3 == 0) eb.y += eb.dy;
+    if (eb.x < 0 || eb.y < BH_TOP || eb.y > 31) eb.dead = true;
+  }
+}
+
+void bhCollide() {
+  PROF_SCOPE(PROF_COLLIDE);
+  bhEnemyLayer.clear();
+  for (int i = 0; i < bhEnemyCount; i++)
+    if (!bhEnemies[i].dead) bhEnemyLayer.add(i, bhEnemies[i].x, bhEnemies[i].y, 5, 5);
+  bhEBulletLayer.clear();
+  for (int i = 0; i < bhEBulletCount; i++)
+    if (!bhEBullets[i].dead) bhEBulletLayer.add(i, bhEBullets[i].x - 1, bhEBullets[i].y - 1, 3, 3);
+
+  auto enemyAlive = [](uint16_t id) { return !bhEnemies[id].dead; };
+  auto eBulletAlive = [](uint16_t id) { return !bhEBullets[id].dead; };
+
+  for (int i = 0; i < bhBulletCount; i++) {
+    BhObj &b = bhBullets[i];
+    if (b.dead) continue;
+    int e = bhEnemyLayer.hit(b.x, b.y, 1, 1, enemyAlive);
+    if (e >= 0) { b.dead = true; bhEnemies[e].dead = true; bhScore++; continue; }
+    int eb = bhEBulletLayer.hit(b.x, b.y, 1, 1, eBulletAlive);
+    if (eb >= 0) { b.dead = true; bhEBullets[eb].dead = true; }
+  }
+
+  int id;
+  while ((id = bhEBulletLayer.hit(4, bhPlayerY, 4, 5, eBulletAlive)) >= 0) {
+    bhEBullets[id].dead = true;
+    bhLives--;
+  }
+  while ((id = bhEnemyLayer.hit(4, bhPlayerY, 4, 5, enemyAlive)) >= 0) {
+    bhEnemies[id].dead = true;
+    bhLives--;
+  }
+
+  bhCompact(bhBullets, bhBulletCount);
+  bhCompact(bhEnemies, bhEnemyCount);
+  bhCompact(bhEBullets, bhEBulletCount);
+}
+
+void bulletHellGameOver() {
+  display.clearDisplay();
+  display.setFont(&FreeSans9pt7b);
+  display.setCursor(26, 14);
+  display.print("Game Over");
+  display.setFont();
+  display.setCursor(32, 24);
+  display.print("Score ");
+  display.print(bhScore);
+  display.display();
+  bhDead = true;
+  bhDeadAt = gameClock;
+}
+
+void bulletHellUpdate() {
+  if (bhDead) {
+    if (gameClock - bhDeadAt >= GAME_OVER_HOLD_MS) bhOver = true;
+    return;
+  }
+
+  ButtonEvent e;
+  while (nextButtonEvent(e)) {}
+  if (buttonDown(8) && bhPlayerY > BH_TOP) bhPlayerY--;
+  if (buttonDown(7) && bhPlayerY < 27) bhPlayerY++;
+
+  // Auto-fire; holding SHOOT widens it to a spread
+  if (gameClock - bhLastShot >= 90) {
+    bhAdd(bhBullets, bhBulletCount, BH_MAX_BULLETS, 8, bhPlayerY + 2, 0);
+    if (buttonDown(6)) {
+      bhAdd(bhBullets, bhBulletCount, BH_MAX_BULLETS, 8, bhPlayerY + 2, -1);
+      bhAdd(bhBullets, bhBulletCount, BH_MAX_BULLETS, 8, bhPlayerY + 2, 1);
+    }
+    bhLastShot = gameClock;
+  }
+
+  if (gameClock - bhLastSpawn >= 150) {
+    bhSpawn();
+    bhLastSpawn = gameClock;
+  }
+
+  if (gameClock - bhLastVolley >= 600) {
+    for (int i = 0; i < bhEnemyCount; i++)
+      if (bhEnemies[i].x < 120 && gameRandom(0, 3) == 0)
+        bhAdd(bhEBullets, bhEBulletCount, BH_MAX_EBULLETS, bhEnemies[i].x - 1, bhEnemies[i].y + 2, gameRandom(-1, 2));
+    bhLastVolley = gameClock;
+  }
+
+  bhMove();
+  bhCollide();
+
+  if (bhLives <= 0) bulletHellGameOver();
+}
+
+void bulletHellRender() {
+  if (bhDead) return;
+  display.clearDisplay();
+  display.drawLine(0, BH_TOP - 1, 127, BH_TOP - 1, SSD1306_WHITE);
+  display.setFont();
+  display.setCursor(0, 1);
+  display.print("L:");
+  display.print(bhLives);
+  display.setCursor(44, 1);
+  display.print("S:");
+  display.print(bhScore);
+
+  uint8_t *fb = display.getBuffer();
+  blitSprite(fb, 4, bhPlayerY, SPRITE_SHIP);
+  for (int i = 0; i < bhBulletCount; i++) blitSprite(fb, bhBullets[i].x, bhBullets[i].y, SPRITE_BULLET);
+  for (int i = 0; i < bhEnemyCount; i++) blitSprite(fb, bhEnemies[i].x, bhEnemies[i].y, SPRITE_ENEMY_B);
+  for (int i = 0; i < bhEBulletCount; i++) blitSprite(fb, bhEBullets[i].x, bhEBullets[i].y, SPRITE_SHOT2);
+  display.display();
+}
+
+bool bulletHellFinished() { return bhOver; }
+
+const Game bulletHellGame = { bulletHellInit, bulletHellUpdate, bulletHellRender, bulletHellFinished, GAME_STEP_MS };
+
+void runBulletHellGame() {
+  runGame(bulletHellGame);
+}
+
+#endif
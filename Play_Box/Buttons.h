@@ -0,0 +1,170 @@
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Profiler.h"
+
+// Interrupt-driven buttons. Each edge is timestamped in the ISR and pushed
+// into a lock-free single-producer/single-consumer ring; nextButtonEvent()
+// debounces those edges and turns them into press/release/hold events, so
+// presses that happen during a slow frame or I2C flush are never lost.
+// Buttons are active low (external pull-ups), on pins 5..8.
+
+#define BUTTON_FIRST_PIN 5
+#define BUTTON_COUNT     4
+#define DEBOUNCE_MS      20
+#define HOLD_MS          1000
+
+enum ButtonEventType : uint8_t { BUTTON_PRESS, BUTTON_RELEASE, BUTTON_HOLD };
+
+struct ButtonEvent {
+  ButtonEventType type;
+  uint8_t pin;
+  uint32_t timeUs;
+};
+
+// N must be a power of two; head is written only by the producer, tail only
+// by the consumer.
+template <typename T, uint8_t N>
+struct SpscRing {
+  T items[N];
+  std::atomic<uint8_t> head{0}, tail{0};
+
+  bool push(const T &v) {
+    uint8_t h = head.load(std::memory_order_relaxed);
+    if ((uint8_t)(h - tail.load(std::memory_order_acquire)) == N) return false;
+    items[h & (N - 1)] = v;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &v) {
+    uint8_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    v = items[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+struct RawEdge {
+  uint8_t pin;
+  uint8_t level;
+  uint32_t timeUs;
+};
+
+struct ButtonState {
+  bool down;            // debounced
+  bool rawDown;         // last level seen from the ISR
+  bool holdSent;
+  uint32_t changedUs;   // time of the last accepted edge
+};
+
+SpscRing<RawEdge, 32> rawEdges;
+SpscRing<ButtonEvent, 16> buttonEvents;
+ButtonState buttonStates[BUTTON_COUNT];
+std::atomic<bool> rawOverflow{false};
+uint32_t buttonEventsDropped = 0;   // events that found the queue full
+bool buttonsFed = false;   // Replay.h sets buttonStates itself; pins are ignored
+
+template <uint8_t PIN>
+void IRAM_ATTR buttonIsr() {
+  RawEdge e = { PIN, (uint8_t)digitalRead(PIN), (uint32_t)micros() };
+  if (!rawEdges.push(e)) rawOverflow.store(true, std::memory_order_relaxed);
+}
+
+void buttonsBegin() {
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    pinMode(BUTTON_FIRST_PIN + i, INPUT);
+    bool down = !digitalRead(BUTTON_FIRST_PIN + i);
+    buttonStates[i] = { down, down, true, (uint32_t)micros() };
+  }
+  attachInterrupt(digitalPinToInterrupt(5), buttonIsr<5>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(6), buttonIsr<6>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(7), buttonIsr<7>, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(8), buttonIsr<8>, CHANGE);
+}
+
+// With the queue full the state is left as it was: pollButtons() sees the
+// level still differs and tries again once there is room, so a press comes
+// late but never without its release
+void acceptButton(uint8_t idx, bool down, uint32_t t) {
+  ButtonState &b = buttonStates[idx];
+  if (b.down == down) return;
+  if (!buttonEvents.push({ down ? BUTTON_PRESS : BUTTON_RELEASE, (uint8_t)(BUTTON_FIRST_PIN + idx), t })) {
+    buttonEventsDropped++;
+    return;
+  }
+  b.down = down;
+  b.changedUs = t;
+  b.holdSent = false;
+}
+
+void checkHold(uint8_t idx, uint32_t now) {
+  ButtonState &b = buttonStates[idx];
+  if (b.down && !b.holdSent && now - b.changedUs >= HOLD_MS * 1000UL) {
+    if (buttonEvents.push({ BUTTON_HOLD, (uint8_t)(BUTTON_FIRST_PIN + idx), now })) b.holdSent = true;
+    else buttonEventsDropped++;
+  }
+}
+
+// Consumer side: debounce raw edges and emit hold events
+void pollButtons() {
+  if (buttonsFed) return;
+  PROF_SCOPE(PROF_INPUT);
+  RawEdge e;
+  while (rawEdges.pop(e)) {
+    uint8_t idx = e.pin - BUTTON_FIRST_PIN;
+    if (idx >= BUTTON_COUNT) continue;
+    ButtonState &b = buttonStates[idx];
+    b.rawDown = !e.level;
+    // First edge counts immediately; bounces inside the window are ignored
+    if (e.timeUs - b.changedUs >= DEBOUNCE_MS * 1000UL) acceptButton(idx, b.rawDown, e.timeUs);
+  }
+
+  if (rawOverflow.exchange(false)) {
+    for (int i = 0; i < BUTTON_COUNT; i++) buttonStates[i].rawDown = !digitalRead(BUTTON_FIRST_PIN + i);
+  }
+
+  uint32_t now = micros();
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    ButtonState &b = buttonStates[i];
+    // Level settled to something other than what we last accepted
+    if (b.rawDown != b.down && now - b.changedUs >= DEBOUNCE_MS * 1000UL) acceptButton(i, b.rawDown, now);
+    checkHold(i, now);
+  }
+}
+
+bool nextButtonEvent(ButtonEvent &e) {
+  pollButtons();
+  return buttonEvents.pop(e);
+}
+
+// Debounced level, for things that act while a button is held
+bool buttonDown(uint8_t pin) {
+  uint8_t idx = pin - BUTTON_FIRST_PIN;
+  return idx < BUTTON_COUNT && buttonStates[idx].down;
+}
+
+void clearButtonEvents() {
+  ButtonEvent e;
+  while (nextButtonEvent(e)) {}
+}
+
+// Take the current pin levels as-is, without events. Edges can be lost
+// while the CPU is in light sleep, so this is called after waking.
+void buttonsResync() {
+  RawEdge e;
+  while (rawEdges.pop(e)) {}
+  rawOverflow.store(false);
+  ButtonEvent ev;
+  while (buttonEvents.pop(ev)) {}
+  uint32_t now = micros();
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    bool down = !digitalRead(BUTTON_FIRST_PIN + i);
+    buttonStates[i] = { down, down, true, now };
+  }
+}
+
+#endif
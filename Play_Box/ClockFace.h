@@ -0,0 +1,127 @@
+#ifndef CLOCK_FACE_H
+#define CLOCK_FACE_H
+
+#include <Adafruit_SSD1306.h>
+#include <Fonts/FreeSans9pt7b.h>
+
+// Clock screen with cached glyphs. The FreeSans time characters are
+// rendered once through Adafruit_GFX at startup and kept as page-format
+// columns (pages 0-1, rows 0-15). A tick copies only the characters that
+// changed straight into the framebuffer. The date and temperature lines use
+// the built-in font and are repainted only when their text changes.
+// Nothing here calls display(): the caller flushes.
+
+#define CLOCK_GLYPH_CHARS  "0123456789: APM"
+#define CLOCK_GLYPH_COUNT  15
+#define CLOCK_GLYPH_COLS   16
+#define CLOCK_TIME_PAGES   2
+#define CLOCK_TEXT_MAX     12
+
+struct CachedGlyph {
+  uint8_t advance;
+  uint8_t cols[CLOCK_TIME_PAGES][CLOCK_GLYPH_COLS];
+};
+
+CachedGlyph clockGlyphs[CLOCK_GLYPH_COUNT];
+char clockTimeShown[CLOCK_TEXT_MAX];
+char clockDateShown[20], clockTempShown[12];
+bool clockFaceValid = false;
+int clockTempX = 96, clockLineY = 24;
+
+// Renders each glyph at `baseline` (must keep it inside rows 0-15) and
+// captures its columns. Uses the framebuffer as scratch, so call before the
+// first frame.
+void clockFaceBegin(Adafruit_SSD1306 &d, int baseline, int tempX) {
+  clockTempX = tempX;
+  const char *chars = CLOCK_GLYPH_CHARS;
+  uint8_t *buf = d.getBuffer();
+  d.setTextSize(1);
+  d.setTextColor(SSD1306_WHITE);
+  d.setFont(&FreeSans9pt7b);
+  for (int g = 0; g < CLOCK_GLYPH_COUNT; g++) {
+    d.clearDisplay();
+    d.setCursor(0, baseline);
+    d.print(chars[g]);
+    int adv = d.getCursorX();
+    clockGlyphs[g].advance = adv > CLOCK_GLYPH_COLS ? CLOCK_GLYPH_COLS : adv;
+    for (int p = 0; p < CLOCK_TIME_PAGES; p++)
+      memcpy(clockGlyphs[g].cols[p], buf + p * d.width(), CLOCK_GLYPH_COLS);
+  }
+  d.setFont();
+  d.clearDisplay();
+  clockFaceValid = false;
+}
+
+// Forget what is on screen, e.g. after the menu or a game drew over it
+void clockFaceInvalidate() { clockFaceValid = false; }
+
+const CachedGlyph &clockGlyph(char c) {
+  const char *at = strchr(CLOCK_GLYPH_CHARS, c);
+  return clockGlyphs[at && c ? at - CLOCK_GLYPH_CHARS : 11];  // unknown -> ' '
+}
+
+// Glyph cells are disjoint, so a cell is overwritten without touching its
+// neighbours; glyph pixels past the advance are clipped.
+void blitGlyph(uint8_t *buf, int width, int x, const CachedGlyph &g) {
+  int n = g.advance;
+  if (x + n > width) n = width - x;
+  if (n <= 0) return;
+  for (int p = 0; p < CLOCK_TIME_PAGES; p++) memcpy(buf + p * width + x, g.cols[p], n);
+}
+
+// `text` like " 9:05:03 AM"
+void clockFaceTime(Adafruit_SSD1306 &d, const char *text) {
+  uint8_t *buf = d.getBuffer();
+  int width = d.width();
+  size_t len = strlen(text);
+  if (len >= CLOCK_TEXT_MAX) len = CLOCK_TEXT_MAX - 1;
+
+  // Same advances at every position means the layout didn't shift, so only
+  // changed characters need a blit.
+  bool sameLayout = clockFaceValid && strlen(clockTimeShown) == len;
+  for (size_t i = 0; sameLayout && i < len; i++)
+    sameLayout = clockGlyph(text[i]).advance == clockGlyph(clockTimeShown[i]).advance;
+
+  if (!sameLayout)
+    for (int p = 0; p < CLOCK_TIME_PAGES; p++) memset(buf + p * width, 0, width);
+
+  int x = 0;
+  for (size_t i = 0; i < len; i++) {
+    const CachedGlyph &g = clockGlyph(text[i]);
+    if (!sameLayout || text[i] != clockTimeShown[i]) blitGlyph(buf, width, x, g);
+    x += g.advance;
+  }
+  memcpy(clockTimeShown, text, len);
+  clockTimeShown[len] = 0;
+}
+
+void clockFaceField(Adafruit_SSD1306 &d, char *shown, size_t cap, int x, int w, const char *text) {
+  if (clockFaceValid && !strcmp(shown, text)) return;
+  d.fillRect(x, clockLineY, w, 8, SSD1306_BLACK);
+  d.setFont();
+  d.setTextSize(1);
+  d.setTextColor(SSD1306_WHITE);
+  d.setCursor(x, clockLineY);
+  d.print(text);
+  strncpy(shown, text, cap - 1);
+  shown[cap - 1] = 0;
+}
+
+void clockFaceDate(Adafruit_SSD1306 &d, const char *text) {
+  clockFaceField(d, clockDateShown, sizeof(clockDateShown), 0, clockTempX, text);
+}
+
+void clockFaceTemp(Adafruit_SSD1306 &d, const char *text) {
+  clockFaceField(d, clockTempShown, sizeof(clockTempShown), clockTempX, d.width() - clockTempX, text);
+}
+
+// Call after the time/date/temp of a full frame have been drawn
+void clockFaceDone(Adafruit_SSD1306 &d) {
+  if (!clockFaceValid) {
+    // Page 2 isn't owned by any field; clear it on full redraws
+    memset(d.getBuffer() + 2 * d.width(), 0, d.width());
+  }
+  clockFaceValid = true;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef COLUMN_COLLIDE_H
+#define COLUMN_COLLIDE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// The screen is 32 px tall, so one uint32_t holds a whole column. A layer
+// rasterizes hitboxes into per-column occupancy masks; overlap tests are an
+// AND per column of the query box. `owner` remembers the lowest id over
+// each pixel so a hit can usually be resolved without scanning the entity
+// list. Entities die while the layer is in use and their bits stay set, so
+// a pixel whose owner is dead may still cover a live entity: then hit()
+// falls back to the clipped boxes the layer keeps, which is exact. Boxes
+// are listed by first column, so that only looks at the few near the query.
+
+#define COLLIDE_WIDTH 128
+
+inline uint32_t rowMask(int y, int h) {
+  if (y < 0) { h += y; y = 0; }
+  if (h <= 0 || y >= 32) return 0;
+  if (y + h > 32) h = 32 - y;
+  return (h == 32 ? 0xFFFFFFFFu : ((1u << h) - 1)) << y;
+}
+
+inline int lowestBit(uint32_t m) { return __builtin_ctz(m); }
+
+// N: most entities added between clear()s
+template <int N>
+struct CollideLayer {
+  uint32_t occ[COLLIDE_WIDTH];
+  uint16_t owner[COLLIDE_WIDTH][32];
+  struct Span {
+    uint8_t x0, x1;   // columns x0 .. x1 - 1
+    uint16_t id;
+    uint32_t bits;
+  } spans[N];
+  int16_t head[COLLIDE_WIDTH];   // first span starting in each column, -1: none
+  int16_t next[N];
+  int count = 0, widest = 0;
+
+  void clear() {
+    memset(occ, 0, sizeof(occ));
+    memset(head, 0xFF, sizeof(head));
+    count = widest = 0;
+  }
+
+  void add(uint16_t id, int x, int y, int w, int h) {
+    uint32_t bits = rowMask(y, h);
+    int x0 = x < 0 ? 0 : x, x1 = x + w > COLLIDE_WIDTH ? COLLIDE_WIDTH : x + w;
+    if (!bits || x0 >= x1 || count == N) return;
+    spans[count] = { (uint8_t)x0, (uint8_t)x1, id, bits };
+    next[count] = head[x0];
+    head[x0] = count++;
+    if (x1 - x0 > widest) widest = x1 - x0;
+    for (int c = x0; c < x1; c++) {
+      for (uint32_t m = bits; m; m &= m - 1) {
+        int r = lowestBit(m);
+        if (!(occ[c] >> r & 1) || id < owner[c][r]) owner[c][r] = id;
+      }
+      occ[c] |= bits;
+    }
+  }
+
+  bool any(int x, int y, int w, int h) const {
+    uint32_t bits = rowMask(y, h);
+    int x0 = x < 0 ? 0 : x, x1 = x + w > COLLIDE_WIDTH ? COLLIDE_WIDTH : x + w;
+    for (int c = x0; c < x1; c++)
+      if (occ[c] & bits) return true;
+    return false;
+  }
+
+  // Lowest id of a live entity overlapping the box, or -1. `alive` lets the
+  // caller skip entities already destroyed this frame.
+  template <typename Alive>
+  int hit(int x, int y, int w, int h, Alive alive) const {
+    uint32_t bits = rowMask(y, h);
+    int x0 = x < 0 ? 0 : x, x1 = x + w > COLLIDE_WIDTH ? COLLIDE_WIDTH : x + w;
+    int best = -1;
+    bool stale = false;
+    for (int c = x0; c < x1; c++)
+      for (uint32_t m = occ[c] & bits; m; m &= m - 1) {
+        uint16_t id = owner[c][lowestBit(m)];
+        if (!alive(id)) stale = true;
+        else if (best < 0 || id < best) best = id;
+      }
+    if (!stale) return best;
+
+    // A dead owner may hide live entities under it
+    best = -1;
+    for (int c = x0 - widest + 1 < 0 ? 0 : x0 - widest + 1; c < x1; c++)
+      for (int i = head[c]; i >= 0; i = next[i]) {
+        const Span &s = spans[i];
+        if (x0 < s.x1 && (s.bits & bits) && (best < 0 || s.id < best) && alive(s.id)) best = s.id;
+      }
+    return best;
+  }
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef FLUSH_PIPE_H
+#define FLUSH_PIPE_H
+
+#include <atomic>
+#include "PageFlush.h"
+
+// Hands finished frames from the drawing core to the flushing core without
+// either side waiting. Three slots rotate through back (being filled by
+// present), middle (published) and front (being sent): present() swaps its
+// slot into the middle, take() swaps the middle out. If a frame is still in
+// the middle when the next one is presented it is replaced, so a slow bus
+// drops frames but always ends up sending the newest one. Each slot also
+// carries the frame's scroll layer positions.
+class FlushPipe {
+public:
+  // Producer side
+  void present(const uint8_t *fb, const FrameScroll *scroll = nullptr) {
+    memcpy(slots[back], fb, FLUSH_BYTES);
+    if (scroll) scrolls[back] = *scroll;
+    else memset(&scrolls[back], 0, sizeof(FrameScroll));
+    uint8_t prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+    if (prev & FRESH) dropped.fetch_add(1, std::memory_order_relaxed);
+    back = prev & SLOT_MASK;
+    presented++;
+  }
+
+  // Consumer side: the newest frame, or nullptr if nothing new
+  const uint8_t *take(const FrameScroll **scroll = nullptr) {
+    if (!(middle.load(std::memory_order_acquire) & FRESH)) return nullptr;
+    front = middle.exchange(front, std::memory_order_acq_rel) & SLOT_MASK;
+    if (scroll) *scroll = &scrolls[front];
+    return slots[front];
+  }
+
+  bool pending() const { return middle.load(std::memory_order_acquire) & FRESH; }
+
+  uint32_t presented = 0;               // producer only
+  std::atomic<uint32_t> dropped{0};
+
+private:
+  static const uint8_t FRESH = 0x80, SLOT_MASK = 0x03;
+  uint8_t slots[3][FLUSH_BYTES];
+  FrameScroll scrolls[3];
+  uint8_t back = 0, front = 1;
+  std::atomic<uint8_t> middle{2};
+};
+
+#endif
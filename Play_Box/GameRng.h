@@ -0,0 +1,30 @@
+#ifndef GAME_RNG_H
+#define GAME_RNG_H
+
+#include <stdint.h>
+
+// Seedable PRNG for game logic (xorshift32). On the ESP32, random() draws
+// from the hardware RNG and can't be replayed, so anything that shapes a
+// game goes through gameRandom() and a seed reproduces the session.
+
+uint32_t gameRngState = 1;
+
+inline void gameSeed(uint32_t seed) { gameRngState = seed ? seed : 0x9E3779B9u; }
+
+inline uint32_t gameRand() {
+  uint32_t x = gameRngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return gameRngState = x;
+}
+
+// Like random(lo, hi): lo <= r < hi
+inline long gameRandom(long lo, long hi) {
+  if (lo >= hi) return lo;
+  return lo + (long)(((uint64_t)gameRand() * (uint32_t)(hi - lo)) >> 32);
+}
+
+inline long gameRandom(long n) { return gameRandom(0, n); }
+
+#endif
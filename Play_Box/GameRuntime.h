@@ -0,0 +1,114 @@
+#ifndef GAME_RUNTIME_H
+#define GAME_RUNTIME_H
+
+#include <Arduino.h>
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "Replay.h"
+
+// Fixed-timestep runner shared by the games. update() always advances the
+// game by exactly stepMs; when rendering falls behind, several updates run
+// back to back and only the last state is drawn. Scheduler tasks run in
+// the gaps between steps.
+//
+// While a session is being recorded or replayed every step is drawn, so the
+// last frame (which the replay check hashes) doesn't depend on timing.
+
+#define GAME_STEP_MS     30
+#define GAME_MAX_CATCHUP 5   // updates per loop before time is dropped
+
+struct Game {
+  void (*init)();
+  void (*update)();
+  void (*render)();
+  bool (*finished)();
+  uint16_t stepMs;
+};
+
+struct GameStats {
+  uint32_t updates;
+  uint32_t renders;
+  uint32_t skippedRenders;
+  uint32_t droppedMs;
+  uint32_t updateUs, renderUs;        // last frame
+  uint32_t maxUpdateUs, maxRenderUs;
+  uint64_t totalUpdateUs, totalRenderUs;
+};
+
+GameStats gameStats;
+uint32_t gameClock = 0;   // ms of game time, advances by stepMs per update
+
+#define GAME_OVER_HOLD_MS 1500  // how long "Game Over" stays up before input counts
+
+void printGameStats() {
+  Serial.printf("game: %lu updates, %lu renders, %lu skipped, %lu ms dropped\n",
+                (unsigned long)gameStats.updates, (unsigned long)gameStats.renders,
+                (unsigned long)gameStats.skippedRenders, (unsigned long)gameStats.droppedMs);
+  if (gameStats.updates && gameStats.renders)
+    Serial.printf("  update avg %lu us max %lu us, render avg %lu us max %lu us\n",
+                  (unsigned long)(gameStats.totalUpdateUs / gameStats.updates),
+                  (unsigned long)gameStats.maxUpdateUs,
+                  (unsigned long)(gameStats.totalRenderUs / gameStats.renders),
+                  (unsigned long)gameStats.maxRenderUs);
+}
+
+void runGame(const Game &game) {
+  memset(&gameStats, 0, sizeof(gameStats));
+  gameClock = 0;
+  game.init();
+
+  unsigned long prev = millis();
+  unsigned long acc = 0;
+
+  while (!game.finished()) {
+    unsigned long now = millis();
+    acc += now - prev;
+    prev = now;
+
+    if (acc > (unsigned long)game.stepMs * GAME_MAX_CATCHUP) {
+      gameStats.droppedMs += acc - game.stepMs * GAME_MAX_CATCHUP;
+      acc = game.stepMs * GAME_MAX_CATCHUP;
+    }
+
+    int steps = 0;
+    unsigned long t0 = micros();
+    while (acc >= game.stepMs && !game.finished() && !(steps && replayActive())) {
+      replayStep(gameClock);
+      {
+        PROF_SCOPE(PROF_UPDATE);
+        game.update();
+      }
+      gameClock += game.stepMs;
+      acc -= game.stepMs;
+      steps++;
+    }
+    if (!steps) {
+      runTasks();  // background work (NTP, WiFi) between steps
+      PROF_POLL();
+      delay(1);
+      continue;
+    }
+
+    gameStats.updates += steps;
+    gameStats.skippedRenders += steps - 1;
+    gameStats.updateUs = micros() - t0;
+    gameStats.totalUpdateUs += gameStats.updateUs;
+    if (gameStats.updateUs > gameStats.maxUpdateUs) gameStats.maxUpdateUs = gameStats.updateUs;
+
+    if (game.finished()) break;
+
+    t0 = micros();
+    {
+      PROF_SCOPE(PROF_RENDER);
+      game.render();
+    }
+    gameStats.renderUs = micros() - t0;
+    gameStats.totalRenderUs += gameStats.renderUs;
+    if (gameStats.renderUs > gameStats.maxRenderUs) gameStats.maxRenderUs = gameStats.renderUs;
+    gameStats.renders++;
+  }
+
+  printGameStats();
+}
+
+#endif
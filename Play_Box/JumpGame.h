@@ -1,25 +1,111 @@
 #ifndef JUMP_GAME_H
 #define JUMP_GAME_H
 
-#include <Adafruit_SSD1306.h>
+#include "PlayDisplay.h"
+#include "GameRuntime.h"
+#include "Buttons.h"
+#include "Physics.h"
+#include "GameRng.h"
 
-extern Adafruit_SSD1306 display;
+extern PlayDisplay display;
+
+// Physics in Physics.h units. The jump keeps the old arc (6 px/frame up,
+// 1 px/frame^2 down at 30 ms frames: about 18 px high, 0.36 s in the air)
+// and the ground starts at the old 3 px/frame, then speeds up steadily
+// to twice that.
+#define JUMP_STEP_MS    GAME_STEP_MS
+#define JUMP_GROUND_Y   20
+#define JUMP_VELOCITY   FX(-200)
+#define JUMP_GRAVITY    FX(1100)
+#define JUMP_SPEED      FX(100)
+#define JUMP_SPEED_MAX  FX(200)
+#define JUMP_RAMP       FX(1.5)   // px/s per second
+#define JUMP_OBSTACLES  3
+#define JUMP_GAP_MIN    90        // px from one obstacle to the next
+#define JUMP_GAP_MAX    140
+
+// Jump Scroll draws the same scene but lets the controller move it: the
+// skyline (page 1, at a quarter of the ground's speed) and the ground
+// (pages 2-3) right of the player are scroll layers, so a frame sends the
+// columns that scrolled in and the player's, not the whole landscape. The
+// controller takes one column per SSD_SCROLL_GAP_US, so the ground holds a
+// speed the two layers fit in (72 + 18 of the 100 columns a second). The
+// flush task sleeps out those gaps; flushing inline, a move that would
+// have to wait is resent instead.
+#define JUMP_SCROLL_C0    11
+#define JUMP_SCROLL_SPEED FX(72)
+
+struct JumpObstacle {
+  int32_t x;     // ground px; on screen at x minus the ground offset
+  uint8_t w, h;
+};
 
 bool jumpOver = false;
-int jumpPlayerY = 20;
-int velocity = 0;
+bool jumpDead = false;
+bool jumpScroll = false;
+uint32_t jumpDeadAt = 0;
+FxBody jumpPlayer, jumpCamera;    // jumpCamera.x: how far the ground has moved
+JumpObstacle jumpObstacles[JUMP_OBSTACLES];
+int jumpPlayerY = JUMP_GROUND_Y;  // pixel position, as last drawn
 bool jumping = false;
-int obstacleX = 128;
 int jumpScore = 0;
 
+inline int32_t jumpGroundOffset() { return jumpCamera.x >> FX_SHIFT; }
+
+// Scenery is a function of the ground column, so a scrolled band and a
+// redrawn one agree
+inline bool jumpPebble(int32_t col) { return ((uint32_t)col * 2654435761u) >> 29 == 0; }
+
+inline int jumpBuilding(int32_t col) {
+  if ((col & 7) == 7) return 0;   // gap between blocks
+  return ((uint32_t)(col >> 3) * 2246822519u) >> 24 & 7;
+}
+
+void drawSkyline(int32_t offset) {
+  for (int x = JUMP_SCROLL_C0; x < FLUSH_WIDTH; x++) {
+    int32_t col = x + offset;
+    int h = jumpBuilding(col);
+    if (!h) continue;
+    display.drawFastVLine(x, 16 - h, h, SSD1306_WHITE);
+    if (h >= 5 && (col & 1)) display.drawPixel(x, 13, SSD1306_BLACK);  // windows
+  }
+}
+
+// The first obstacle past the player, or -1
+int jumpNextObstacle() {
+  int32_t g = jumpGroundOffset();
+  int next = -1;
+  for (int i = 0; i < JUMP_OBSTACLES; i++) {
+    const JumpObstacle &o = jumpObstacles[i];
+    if (o.x + o.w - g > 5 && (next < 0 || o.x < jumpObstacles[next].x)) next = i;
+  }
+  return next;
+}
+
+void jumpSpawn(JumpObstacle &o) {
+  int32_t last = 0;
+  for (const JumpObstacle &other : jumpObstacles) last = max(last, other.x);
+  o.x = last + gameRandom(JUMP_GAP_MIN, JUMP_GAP_MAX + 1);
+  o.w = gameRandom(3, 8);
+  o.h = gameRandom(5, 11);
+}
+
 void drawJumpScene() {
+  int32_t g = jumpGroundOffset(), sky = g >> 2;
   display.clearDisplay();
+  drawSkyline(sky);
   display.drawLine(0, 30, 128, 30, SSD1306_WHITE);
+  for (int x = 0; x < FLUSH_WIDTH; x++)
+    if (jumpPebble(x + g)) display.drawPixel(x, 31, SSD1306_WHITE);
+  for (const JumpObstacle &o : jumpObstacles) display.fillRect(o.x - g, 30 - o.h, o.w, o.h, SSD1306_WHITE);
   display.fillRect(5, jumpPlayerY, 5, 10, SSD1306_WHITE);  // Dinosaur
-  display.fillRect(obstacleX, 22, 5, 8, SSD1306_WHITE);  // Obstacle
   display.setCursor(0, 0);
   display.print("S-");
   display.print(jumpScore);
+  if (jumpScroll) {
+    display.scrollTo(0, g);
+    display.scrollTo(1, sky);
+  }
   display.display();
 }
 
@@ -33,47 +119,108 @@ void gameOverJump() {
   display.setCursor(34, 24);
   display.print("Restart it..>");
   display.display();
-  delay(1500);
-  jumpOver = true;
+  jumpDead = true;
+  jumpDeadAt = gameClock;
 }
 
-void runJumpGame() {
-  jumpPlayerY = 20;
-  velocity = 0;
+void jumpStart() {
+  jumpPlayer = { FX(5), FX(JUMP_GROUND_Y), 0, 0, 0, 0 };
+  if (jumpScroll) jumpCamera = { 0, 0, JUMP_SCROLL_SPEED, 0, 0, 0 };
+  else jumpCamera = { 0, 0, JUMP_SPEED, 0, JUMP_RAMP, 0 };
+  for (JumpObstacle &o : jumpObstacles) o.x = 0;
+  jumpSpawn(jumpObstacles[0]);
+  jumpObstacles[0].x = 128;   // the first one comes in at the edge
+  for (int i = 1; i < JUMP_OBSTACLES; i++) jumpSpawn(jumpObstacles[i]);
+  jumpPlayerY = JUMP_GROUND_Y;
   jumping = false;
-  obstacleX = 128;
   jumpScore = 0;
   jumpOver = false;
+  jumpDead = false;
+  clearButtonEvents();
+}
 
-  while (!jumpOver) {
-    if (!digitalRead(5) && !jumping) {
-      jumping = true;
-      velocity = -6;
-    }
+void jumpInit() {
+  jumpScroll = false;
+  display.clearScroll();
+  jumpStart();
+}
+
+void jumpScrollInit() {
+  jumpScroll = true;
+  // The ground first: it is the costlier band to resend if the flush
+  // runs out of time for both
+  display.setScrollLayer(0, 2, 3, JUMP_SCROLL_C0, FLUSH_WIDTH - 1);
+  display.setScrollLayer(1, 1, 1, JUMP_SCROLL_C0, FLUSH_WIDTH - 1);
+  jumpStart();
+}
+
+void jumpUpdate() {
+  if (jumpDead) {
+    if (gameClock - jumpDeadAt >= GAME_OVER_HOLD_MS) jumpOver = true;
+    return;
+  }
+
+  ButtonEvent e;
+  bool jumpPressed = false;
+  while (nextButtonEvent(e))
+    if (e.type == BUTTON_PRESS && e.pin == 5) jumpPressed = true;
+
+  if ((jumpPressed || buttonDown(5)) && !jumping) {
+    jumping = true;
+    jumpPlayer.vy = JUMP_VELOCITY;
+    jumpPlayer.ay = JUMP_GRAVITY;
+  }
 
-    if (jumping) {
-      jumpPlayerY += velocity;
-      velocity += 1;
-      if (jumpPlayerY >= 20) {
-        jumpPlayerY = 20;
-        velocity = 0;
-        jumping = false;
-      }
+  fx playerDy = 0, groundDx;
+  if (jumping) {
+    jumpPlayer.step(JUMP_STEP_MS, nullptr, &playerDy);
+    if (jumpPlayer.y >= FX(JUMP_GROUND_Y)) {
+      playerDy -= jumpPlayer.y - FX(JUMP_GROUND_Y);
+      jumpPlayer.y = FX(JUMP_GROUND_Y);
+      jumpPlayer.vy = jumpPlayer.ay = 0;
+      jumping = false;
     }
+  }
+
+  jumpCamera.step(JUMP_STEP_MS, &groundDx);
+  if (jumpCamera.vx >= JUMP_SPEED_MAX) {
+    jumpCamera.vx = JUMP_SPEED_MAX;
+    jumpCamera.ax = 0;
+  }
 
-    obstacleX -= 3;
-    if (obstacleX < -5) {
-      obstacleX = 128;
+  // Swept, so a fast obstacle can't hop over the player between frames
+  FxBox player = { jumpPlayer.x, jumpPlayer.y, FX(5), FX(10) };
+  bool hit = false;
+  int32_t g = jumpGroundOffset();
+  for (JumpObstacle &o : jumpObstacles) {
+    FxBox obstacle = { FX(o.x) - jumpCamera.x, FX(30 - o.h), FX(o.w), FX(o.h) };
+    hit |= fxSweep(player, 0, playerDy, obstacle, -groundDx, 0) >= 0;
+    if (o.x + o.w < g) {
+      jumpSpawn(o);
       jumpScore++;
     }
+  }
+  jumpPlayerY = fxPx(jumpPlayer.y);
 
-    if (obstacleX < 10 && obstacleX + 5 > 5 && jumpPlayerY + 10 > 22) {
-      gameOverJump();
-      break;
-    }
+  if (hit) gameOverJump();
+}
 
-    drawJumpScene();
-    delay(30);
-  }
+bool jumpFinished() { return jumpOver; }
+
+void jumpRender() {
+  if (!jumpDead) drawJumpScene();
+}
+
+const Game jumpGame = { jumpInit, jumpUpdate, jumpRender, jumpFinished, JUMP_STEP_MS };
+const Game jumpScrollGame = { jumpScrollInit, jumpUpdate, jumpRender, jumpFinished, JUMP_STEP_MS };
+
+
+void runJumpGame() {
+  runGame(jumpGame);
+}
+
+void runJumpScrollGame() {
+  runGame(jumpScrollGame);
+  display.clearScroll();
 }
 #endif
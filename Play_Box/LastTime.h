@@ -0,0 +1,39 @@
+#ifndef LAST_TIME_H
+#define LAST_TIME_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Last known wall-clock time, so a reboot can show the clock before NTP
+// answers. The RTC copy is RTC_NOINIT_ATTR, left alone by software,
+// watchdog and brownout resets (RTC_DATA_ATTR would be reloaded on all of
+// them) and cheap, so it is written every tick. It holds garbage after power
+// loss, hence the magic. Preferences survives power loss but wears flash, so
+// it is only written on NTP syncs.
+
+#define LAST_TIME_MAGIC 0x54494D45UL  // "TIME"
+
+struct LastTime {
+  uint32_t magic;
+  uint64_t unixMs;
+};
+
+RTC_NOINIT_ATTR LastTime rtcLastTime;
+
+void rememberTime(uint64_t unixMs) {
+  rtcLastTime.unixMs = unixMs;
+  rtcLastTime.magic = LAST_TIME_MAGIC;
+}
+
+void persistTime(Preferences &prefs, uint64_t unixMs) {
+  rememberTime(unixMs);
+  prefs.putULong64("unixMs", unixMs);
+}
+
+// Unix ms, or 0 if nothing was ever saved
+uint64_t restoreTime(Preferences &prefs) {
+  if (rtcLastTime.magic == LAST_TIME_MAGIC) return rtcLastTime.unixMs;
+  return prefs.getULong64("unixMs", 0);
+}
+
+#endif
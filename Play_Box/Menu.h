@@ -0,0 +1,184 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include <Adafruit_SSD1306.h>
+#include "Sprites.h"
+
+// Table-driven menus. A menu is a constexpr array of MenuEntry; an entry
+// either runs something or opens a nested menu, and every menu gets a
+// "Back" row at the end. Three rows are visible at a time.
+//
+// Drawing is retained. Moving the cursor inside the window redraws the two
+// cursor marks. Scrolling shifts the rows already on screen by one row
+// height and draws only the row that came in. Nothing here calls display():
+// the caller flushes, and only the changed columns go out.
+
+#define MENU_ROWS     3
+#define MENU_ROW_H    10
+#define MENU_ICON_X   9
+#define MENU_TEXT_X   18
+#define MENU_DEPTH    4
+
+struct MenuEntry {
+  const char *name;
+  const Sprite *icon;          // may be null
+  void (*run)();               // null for a submenu
+  void (*init)();              // optional, called once before the first run
+  const MenuEntry *sub;        // nested menu
+  uint8_t subCount;
+};
+
+constexpr MenuEntry menuItem(const char *name, const Sprite *icon, void (*run)(), void (*init)() = nullptr) {
+  return { name, icon, run, init, nullptr, 0 };
+}
+
+template <size_t N>
+constexpr MenuEntry subMenu(const char *name, const Sprite *icon, const MenuEntry (&items)[N]) {
+  return { name, icon, nullptr, nullptr, items, (uint8_t)N };
+}
+
+struct MenuLevel {
+  const MenuEntry *items;
+  uint8_t count;          // entries, not counting Back
+  uint8_t sel, top;       // cursor row and first visible row
+};
+
+MenuLevel menuStack[MENU_DEPTH];
+uint8_t menuDepth = 0;
+bool menuValid = false;   // the screen shows menuStack[menuDepth]
+uint8_t menuShownSel, menuShownTop;
+
+const MenuEntry *menuInited[16];
+uint8_t menuInitedCount = 0;
+
+inline MenuLevel &menuLevel() { return menuStack[menuDepth]; }
+inline uint8_t menuRows(const MenuLevel &m) { return m.count + 1; }
+
+void menuOpen(const MenuEntry *items, uint8_t count) {
+  menuDepth = 0;
+  menuStack[0] = { items, count, 0, 0 };
+  menuValid = false;
+}
+
+template <size_t N>
+void menuOpen(const MenuEntry (&items)[N]) { menuOpen(items, N); }
+
+// Forget what is on screen, e.g. after a game or the clock drew over it
+void menuInvalidate() { menuValid = false; }
+
+void menuDrawCursor(Adafruit_SSD1306 &d, int slot, uint16_t color) {
+  d.fillRect(0, slot * MENU_ROW_H, 6, 8, SSD1306_BLACK);
+  if (color == SSD1306_BLACK) return;
+  d.setCursor(0, slot * MENU_ROW_H);
+  d.print('>');
+}
+
+void menuDrawRow(Adafruit_SSD1306 &d, const MenuLevel &m, int slot) {
+  int row = m.top + slot, y = slot * MENU_ROW_H;
+  d.fillRect(0, y, d.width(), MENU_ROW_H, SSD1306_BLACK);
+  if (row >= menuRows(m)) return;
+  bool back = row == m.count;
+  const MenuEntry *e = back ? nullptr : &m.items[row];
+  const Sprite *icon = back ? &ICON_BACK : e->icon;
+  if (icon) blitSprite(d.getBuffer(), MENU_ICON_X, y + (8 - icon->h) / 2, *icon);
+  d.setCursor(MENU_TEXT_X, y);
+  d.print(back ? "Back" : e->name);
+  if (e && e->sub) {
+    d.setCursor(d.width() - 6, y);
+    d.print('>');
+  }
+  if (row == m.sel) menuDrawCursor(d, slot, SSD1306_WHITE);
+}
+
+// Moves the menu rows (the top MENU_ROWS * MENU_ROW_H pixels) by `rows`
+// whole rows, down if positive; page-format columns make this a shift of
+// one 32-bit word per column
+void menuShift(Adafruit_SSD1306 &d, int rows) {
+  uint8_t *fb = d.getBuffer();
+  int w = d.width(), px = rows * MENU_ROW_H;
+  const uint32_t area = (1u << (MENU_ROWS * MENU_ROW_H)) - 1;
+  for (int x = 0; x < w; x++) {
+    uint32_t col = fb[x] | fb[w + x] << 8 | fb[2 * w + x] << 16 | (uint32_t)fb[3 * w + x] << 24;
+    uint32_t moved = (px > 0 ? col << px : col >> -px) & area;
+    col = (col & ~area) | moved;
+    for (int p = 0; p < 4; p++) fb[p * w + x] = col >> (8 * p);
+  }
+}
+
+void menuDraw(Adafruit_SSD1306 &d) {
+  const MenuLevel &m = menuLevel();
+  d.setFont();
+  d.setTextSize(1);
+  d.setTextColor(SSD1306_WHITE);
+
+  if (!menuValid) {
+    d.clearDisplay();
+    for (int s = 0; s < MENU_ROWS; s++) menuDrawRow(d, m, s);
+  } else {
+    int scroll = menuShownTop - m.top;   // rows the content moves down
+    if (scroll && abs(scroll) < MENU_ROWS) {
+      menuDrawCursor(d, menuShownSel - menuShownTop, SSD1306_BLACK);
+      menuShift(d, scroll);
+      if (scroll > 0)
+        for (int s = 0; s < scroll; s++) menuDrawRow(d, m, s);
+      else
+        for (int s = MENU_ROWS + scroll; s < MENU_ROWS; s++) menuDrawRow(d, m, s);
+      menuDrawCursor(d, m.sel - m.top, SSD1306_WHITE);
+    } else if (scroll) {
+      for (int s = 0; s < MENU_ROWS; s++) menuDrawRow(d, m, s);
+    } else if (menuShownSel != m.sel) {
+      menuDrawCursor(d, menuShownSel - m.top, SSD1306_BLACK);
+      menuDrawCursor(d, m.sel - m.top, SSD1306_WHITE);
+    }
+  }
+  menuValid = true;
+  menuShownSel = m.sel;
+  menuShownTop = m.top;
+}
+
+// Cursor up (-1) or down (+1), wrapping; the window follows the cursor
+void menuMove(int delta) {
+  MenuLevel &m = menuLevel();
+  int rows = menuRows(m);
+  m.sel = (m.sel + delta + rows) % rows;
+  if (m.sel < m.top) m.top = m.sel;
+  if (m.sel >= m.top + MENU_ROWS) m.top = m.sel - MENU_ROWS + 1;
+}
+
+enum MenuResult { MENU_NONE, MENU_RUN, MENU_EXIT };
+
+// SELECT on the cursor row. Opens a submenu or leaves one (MENU_NONE, the
+// menu needs a redraw), leaves the top menu (MENU_EXIT), or hands back the
+// entry to run (MENU_RUN, in *entry).
+MenuResult menuSelect(const MenuEntry **entry) {
+  MenuLevel &m = menuLevel();
+  menuValid = false;
+  if (m.sel == m.count) {
+    if (!menuDepth) return MENU_EXIT;
+    menuDepth--;
+    return MENU_NONE;
+  }
+  const MenuEntry &e = m.items[m.sel];
+  if (e.sub && menuDepth + 1 < MENU_DEPTH) {
+    menuStack[++menuDepth] = { e.sub, e.subCount, 0, 0 };
+    return MENU_NONE;
+  }
+  menuValid = true;
+  *entry = &e;
+  return e.run ? MENU_RUN : MENU_NONE;
+}
+
+// Runs an entry, calling its init hook the first time
+void menuRun(const MenuEntry *e) {
+  if (e->init) {
+    bool seen = false;
+    for (int i = 0; i < menuInitedCount; i++) seen |= menuInited[i] == e;
+    if (!seen) {
+      e->init();
+      if (menuInitedCount < 16) menuInited[menuInitedCount++] = e;
+    }
+  }
+  e->run();
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef NTP_SYNC_H
+#define NTP_SYNC_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+// Non-blocking SNTP. update() never waits on the network: when a sync is due
+// it sends a request and returns, and a later call picks the reply up. Lost
+// replies time out and retry with backoff. Between syncs time comes from
+// millis(), corrected by the oscillator drift measured across syncs, so the
+// interval can back off to hours once the clock holds.
+//
+// Poll update() every few ms while a request is out: the round trip, and so
+// the correction applied to the server time, is measured at poll resolution.
+
+#define NTP_PORT            123
+#define NTP_PACKET_SIZE     48
+#define NTP_UNIX_OFFSET     2208988800ULL       // 1900 -> 1970
+#define NTP_TIMEOUT_MS      2000
+#define NTP_MIN_INTERVAL_MS 64000UL
+#define NTP_MAX_INTERVAL_MS (4UL * 3600000UL)
+#define NTP_RETRY_MIN_MS    2000UL
+#define NTP_RETRY_MAX_MS    (5UL * 60000UL)
+#define NTP_GOOD_ERROR_MS   50                  // sync error that lets the interval grow
+#define NTP_DRIFT_SPAN_MS   (15UL * 60000UL)    // shortest baseline for a drift estimate
+#define NTP_MAX_DRIFT_PPM   500
+#define NTP_RESOLVE_AFTER   3                   // failures before the name is looked up again
+
+class AsyncNtp {
+public:
+  AsyncNtp(WiFiUDP &udp, const char *server, long offsetSec = 0, uint16_t port = NTP_PORT)
+    : udp(udp), server(server), port(port), offset(offsetSec) {}
+
+  void begin() {
+    udp.begin(0);
+    started = true;
+    waiting = false;
+    resolved = false;
+    nextAt = millis();
+    retryMs = NTP_RETRY_MIN_MS;
+  }
+
+  void end() {
+    udp.stop();
+    started = waiting = false;
+  }
+
+  // Returns true on the call that applied a new sync
+  bool update() {
+    if (!started) return false;
+    uint32_t now = millis();
+    if (waiting) {
+      if (receive(now)) return true;
+      if (now - sentAt >= NTP_TIMEOUT_MS) {
+        timeouts++;
+        fail(now);
+      }
+      return false;
+    }
+    if ((int32_t)(now - nextAt) >= 0) send(now);
+    return false;
+  }
+
+  // Next sync as soon as possible, e.g. after the link comes back
+  void syncSoon() {
+    if (!waiting) nextAt = millis();
+  }
+
+  bool isTimeSet() const { return synced; }
+  bool hasTime() const { return timeKnown; }   // synced, or given a guess
+
+  // A starting guess (e.g. the last known time) until the first sync
+  void setTime(uint64_t unixMs) {
+    if (synced) return;
+    baseMs = unixMs;
+    anchorMs = millis();
+    timeKnown = true;
+  }
+
+  // Unix ms (UTC) from the local clock
+  uint64_t unixMs() const { return unixMsAt(millis()); }
+  unsigned long getEpochTime() const { return unixMs() / 1000 + offset; }
+  void setTimeOffset(long sec) { offset = sec; }
+
+  int32_t driftPpm() const { return drift; }
+  uint32_t intervalMs() const { return interval; }
+  int32_t lastErrorMs() const { return lastError; }
+  uint32_t syncs = 0, timeouts = 0, sendFailures = 0;
+
+private:
+  WiFiUDP &udp;
+  const char *server;
+  uint16_t port;
+  long offset;
+  IPAddress ip;
+  bool started = false, waiting = false, resolved = false, synced = false, driftKnown = false;
+  bool timeKnown = false;
+  uint32_t sentAt = 0, nextAt = 0, interval = NTP_MIN_INTERVAL_MS, retryMs = NTP_RETRY_MIN_MS;
+  uint32_t failures = 0, cookie = 0;
+  uint64_t baseMs = 0;         // unix ms at anchorMs
+  uint32_t anchorMs = 0;
+  uint64_t refServerMs = 0;    // drift baseline
+  uint32_t refLocalMs = 0;
+  int32_t drift = 0, lastError = 0;
+
+  uint64_t unixMsAt(uint32_t now) const {
+    if (!timeKnown) return (uint64_t)now;
+    int64_t elapsed = (uint32_t)(now - anchorMs);
+    return baseMs + elapsed + elapsed * drift / 1000000;
+  }
+
+  static uint64_t readNtpMs(const uint8_t *p) {
+    uint32_t sec = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    uint32_t frac = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+    uint64_t s = sec;
+    if (!(sec & 0x80000000)) s += 1ULL << 32;  // era 1, from 2036
+    return (s - NTP_UNIX_OFFSET) * 1000ULL + (((uint64_t)frac * 1000) >> 32);
+  }
+
+  void fail(uint32_t now) {
+    waiting = false;
+    if (++failures % NTP_RESOLVE_AFTER == 0) resolved = false;
+    nextAt = now + retryMs;
+    retryMs = min<uint32_t>(retryMs * 2, NTP_RETRY_MAX_MS);
+  }
+
+  void send(uint32_t now) {
+    // Stale replies from a timed-out request would otherwise be read first
+    while (udp.parsePacket() > 0) udp.flush();
+
+    // The lookup can block briefly, so it is done once and cached
+    if (!resolved) resolved = WiFi.hostByName(server, ip);
+    if (!resolved) {
+      sendFailures++;
+      fail(now);
+      return;
+    }
+
+    // The server echoes our transmit timestamp; a counter makes replies to
+    // earlier requests easy to reject
+    uint8_t p[NTP_PACKET_SIZE] = { 0x23 };  // LI 0, version 4, client
+    cookie++;
+    for (int i = 0; i < 4; i++) p[44 + i] = cookie >> (24 - 8 * i);
+    if (!udp.beginPacket(ip, port) || udp.write(p, sizeof(p)) != sizeof(p) || !udp.endPacket()) {
+      sendFailures++;
+      fail(now);
+      return;
+    }
+    sentAt = now;
+    waiting = true;
+  }
+
+  bool receive(uint32_t now) {
+    for (int n; (n = udp.parsePacket()) > 0;) {
+      uint8_t p[NTP_PACKET_SIZE];
+      if (n < NTP_PACKET_SIZE) { udp.flush(); continue; }
+      udp.read(p, sizeof(p));
+      udp.flush();
+      bool echoed = true;
+      for (int i = 0; i < 4; i++) echoed &= p[28 + i] == (uint8_t)(cookie >> (24 - 8 * i));
+      if ((p[0] & 7) != 4 || p[1] == 0 || !echoed) continue;  // not a server reply to this request
+      apply(p, now);
+      return true;
+    }
+    return false;
+  }
+
+  void apply(const uint8_t *p, uint32_t now) {
+    uint32_t rtt = now - sentAt;
+    uint64_t rx = readNtpMs(p + 32), tx = readNtpMs(p + 40);
+    uint32_t held = tx > rx ? min<uint64_t>(tx - rx, rtt) : 0;  // time the server sat on it
+    uint64_t serverNow = tx + (rtt - held) / 2;
+
+    if (synced) {
+      lastError = (int64_t)(serverNow - unixMsAt(now));
+      uint32_t span = now - refLocalMs;
+      if (span >= NTP_DRIFT_SPAN_MS) {
+        int64_t measured = ((int64_t)(serverNow - refServerMs) - span) * 1000000 / span;
+        if (measured > NTP_MAX_DRIFT_PPM) measured = NTP_MAX_DRIFT_PPM;
+        if (measured < -NTP_MAX_DRIFT_PPM) measured = -NTP_MAX_DRIFT_PPM;
+        drift = driftKnown ? (drift + measured) / 2 : measured;
+        driftKnown = true;
+        refServerMs = serverNow;
+        refLocalMs = now;
+      }
+      // Grow the interval while the local clock holds, shrink it when it doesn't
+      if (abs(lastError) <= NTP_GOOD_ERROR_MS) interval = min<uint32_t>(interval * 2, NTP_MAX_INTERVAL_MS);
+      else interval = max<uint32_t>(interval / 2, NTP_MIN_INTERVAL_MS);
+    } else {
+      refServerMs = serverNow;
+      refLocalMs = now;
+    }
+
+    baseMs = serverNow;
+    anchorMs = now;
+    synced = timeKnown = true;
+    syncs++;
+    failures = 0;
+    retryMs = NTP_RETRY_MIN_MS;
+    waiting = false;
+    nextAt = now + interval;
+  }
+};
+
+#endif
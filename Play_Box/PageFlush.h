@@ -0,0 +1,165 @@
+#ifndef PAGE_FLUSH_H
+#define PAGE_FLUSH_H
+
+#include <stdint.h>
+#include <string.h>
+
+// SSD1306 128x32: 4 pages of 8 rows, one byte per column per page.
+#define FLUSH_WIDTH   128
+#define FLUSH_PAGES   4
+#define FLUSH_BYTES   (FLUSH_WIDTH * FLUSH_PAGES)
+
+#define SSD_COLUMNADDR 0x21
+#define SSD_PAGEADDR   0x22
+#define SSD_SCROLL_RIGHT_ONE 0x2C   // content scroll, one column per command
+#define SSD_SCROLL_LEFT_ONE  0x2D
+
+#define FLUSH_SPLIT_GAP  10   // unchanged columns that pay for a new window
+#define SCROLL_LAYERS    2
+#define SCROLL_MAX_STEPS 16   // a layer that moved further is resent instead
+
+// A band of pages and columns that the controller shifts in its own RAM
+// (content scroll), so moving it costs a command per column instead of the
+// band's bytes. offset is how many columns it has been scrolled left in
+// total; frames carry where each layer should be rather than how far to
+// move it, so a dropped frame loses nothing.
+struct ScrollLayer {
+  bool on;
+  uint8_t p0, p1, c0, c1;
+  int32_t offset;
+};
+
+struct FrameScroll {
+  ScrollLayer layer[SCROLL_LAYERS];
+};
+
+// Where flushed bytes go. Implementations count what they put on the wire,
+// including the address and control byte of every I2C transaction.
+class DisplayBus {
+public:
+  virtual ~DisplayBus() {}
+  virtual void command(const uint8_t *cmds, uint8_t n) = 0;
+  virtual void data(const uint8_t *bytes, uint16_t n) = 0;
+  // A clock for commands that must be spaced out; waitUs() may sleep the
+  // calling task. Without one nothing waits.
+  virtual uint32_t nowUs() { return 0; }
+  virtual void waitUs(uint32_t us) {}
+  uint32_t bytesSent = 0;
+};
+
+// Keeps a copy of what the controller RAM holds and sends only the columns
+// that differ: one column/page address window per run of changed columns,
+// where runs less than FLUSH_SPLIT_GAP apart share a window. Scroll layers
+// are moved first, in the controller and in the copy alike, so only what
+// scrolled in (and whatever else changed) is left to send.
+//
+// Content scroll commands have to be scrollGapUs apart, and a flush waits
+// at most scrollWaitUs in all for them: a layer whose steps don't fit in
+// what is left of that is resent instead of scrolled.
+class PageFlusher {
+public:
+  DisplayBus *bus = nullptr;
+  uint16_t frameBytes = 0;   // wire bytes of the last flush
+  uint8_t dirtyPages = 0;    // pages touched by the last flush
+  uint32_t scrollGapUs = 0;
+  uint32_t scrollWaitUs = 0;
+
+  void invalidate() { shadowValid = false; }
+
+  void flush(const uint8_t *fb, const FrameScroll *scroll = nullptr) {
+    if (!bus) return;
+    uint32_t before = bus->bytesSent;
+    dirtyPages = 0;
+    scrollSteps = 0;
+    scrollWaited = 0;
+
+    if (!shadowValid) {
+      sendWindow(fb, 0, FLUSH_WIDTH - 1, 0, FLUSH_PAGES - 1);
+      memcpy(shadow, fb, FLUSH_BYTES);
+      shadowValid = true;
+      dirtyPages = FLUSH_PAGES;
+      for (int i = 0; scroll && i < SCROLL_LAYERS; i++) panelAt[i] = scroll->layer[i].offset;
+    } else {
+      for (int i = 0; scroll && i < SCROLL_LAYERS; i++) scrollLayer(fb, scroll->layer[i], panelAt[i]);
+      for (uint8_t p = 0; p < FLUSH_PAGES; p++) {
+        const uint8_t *row = fb + p * FLUSH_WIDTH;
+        uint8_t *old = shadow + p * FLUSH_WIDTH;
+        bool dirty = false;
+        for (int c = 0;;) {
+          while (c < FLUSH_WIDTH && row[c] == old[c]) c++;
+          if (c == FLUSH_WIDTH) break;
+          int lo = c, hi = c;
+          for (int same = 0; ++c < FLUSH_WIDTH;) {
+            if (row[c] != old[c]) hi = c, same = 0;
+            else if (++same > FLUSH_SPLIT_GAP) break;
+          }
+          sendWindow(row + lo, lo, hi, p, p);
+          memcpy(old + lo, row + lo, hi - lo + 1);
+          c = hi + 1;
+          dirty = true;
+        }
+        dirtyPages += dirty;
+      }
+    }
+    frameBytes = bus->bytesSent - before;
+  }
+
+  uint16_t scrollSteps = 0;  // content scroll commands in the last flush
+  uint32_t scrollResends = 0;   // layer moves that didn't fit the wait budget
+
+private:
+  uint8_t shadow[FLUSH_BYTES];
+  bool shadowValid = false;
+  int32_t panelAt[SCROLL_LAYERS] = {};   // layer offsets the controller RAM is at
+  uint32_t scrollAt = 0;       // bus time of the last content scroll command
+  uint32_t scrollWaited = 0;   // in this flush
+
+  // Time until the next content scroll command may go
+  uint32_t scrollDue() {
+    uint32_t since = bus->nowUs() - scrollAt;
+    return since < scrollGapUs ? scrollGapUs - since : 0;
+  }
+
+  // Brings the controller's copy of a layer to l.offset. What the
+  // controller shifts in at the trailing edge isn't relied on: those
+  // columns are set to differ from fb so the diff sends them.
+  void scrollLayer(const uint8_t *fb, const ScrollLayer &l, int32_t &at) {
+    int32_t d = l.offset - at;
+    at = l.offset;
+    int width = l.c1 - l.c0 + 1;
+    int n = d < 0 ? -d : d;
+    if (!l.on || !n || n > SCROLL_MAX_STEPS || n >= width) return;
+    uint32_t wait = scrollGapUs ? scrollDue() + (n - 1) * scrollGapUs : 0;
+    if (scrollWaited + wait > scrollWaitUs) {
+      scrollResends++;
+      return;
+    }
+    scrollWaited += wait;
+
+    const uint8_t cmds[] = { (uint8_t)(d > 0 ? SSD_SCROLL_LEFT_ONE : SSD_SCROLL_RIGHT_ONE), 0x00, l.p0, 0x01, l.p1, 0x00, l.c0, l.c1 };
+    for (int i = 0; i < n; i++) {
+      if (uint32_t due = scrollGapUs ? scrollDue() : 0) bus->waitUs(due);
+      bus->command(cmds, sizeof(cmds));
+      scrollAt = bus->nowUs();
+    }
+    scrollSteps += n;
+
+    for (int p = l.p0; p <= l.p1; p++) {
+      uint8_t *old = shadow + p * FLUSH_WIDTH;
+      const uint8_t *row = fb + p * FLUSH_WIDTH;
+      int in = d > 0 ? l.c1 - n + 1 : l.c0;   // first column shifted in
+      if (d > 0) memmove(old + l.c0, old + l.c0 + n, width - n);
+      else memmove(old + l.c0 + n, old + l.c0, width - n);
+      for (int c = in; c < in + n; c++) old[c] = ~row[c];
+    }
+  }
+
+  void sendWindow(const uint8_t *src, uint8_t c0, uint8_t c1, uint8_t p0, uint8_t p1) {
+    const uint8_t cmds[] = { SSD_COLUMNADDR, c0, c1, SSD_PAGEADDR, p0, p1 };
+    bus->command(cmds, sizeof(cmds));
+    // Only single-page or full-width windows are sent, so src is contiguous
+    bus->data(src, (c1 - c0 + 1) * (p1 - p0 + 1));
+  }
+};
+
+#endif
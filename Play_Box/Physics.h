@@ -0,0 +1,90 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <Arduino.h>
+
+// Fixed-point physics shared by the arcade games. Positions are Q8 pixels
+// (fx, 1/256 px), velocities Q8 pixels per second and accelerations Q8
+// pixels per second squared, so speeds don't depend on how often a game
+// steps: every update moves things by what its elapsed time is worth.
+//
+// FX() takes a constant in pixels (or px/s): FX(66.7) is two pixels per
+// 30 ms step. The sums are done in 64 bits and rounded, not truncated, so
+// a speed that is a whole number of pixels per step stays exact.
+
+typedef int32_t fx;
+
+#define FX_SHIFT 8
+#define FX_ONE   (1 << FX_SHIFT)
+#define FX(v)    ((fx)((v) * FX_ONE))
+
+inline int fxPx(fx v) { return (v + FX_ONE / 2) >> FX_SHIFT; }  // nearest pixel
+
+// Rounded n / d for d > 0
+inline int64_t fxDiv(int64_t n, int64_t d) { return (n < 0 ? n - d / 2 : n + d / 2) / d; }
+
+// Distance covered in dtMs at velocity v
+inline fx fxTravel(fx v, uint32_t dtMs) { return (fx)fxDiv((int64_t)v * dtMs, 1000); }
+
+// A point mass under constant acceleration. step() uses the closed form
+// (x += v t + a t^2 / 2), so an arc is the same shape at any step length.
+struct FxBody {
+  fx x, y, vx, vy, ax, ay;
+
+  // Returns the displacement in *dx, *dy for swept tests
+  void step(uint32_t dtMs, fx *dx = nullptr, fx *dy = nullptr) {
+    int64_t t = dtMs, t2 = t * t;
+    fx mx = (fx)fxDiv((int64_t)vx * t * 2000 + (int64_t)ax * t2, 2000000);
+    fx my = (fx)fxDiv((int64_t)vy * t * 2000 + (int64_t)ay * t2, 2000000);
+    x += mx;
+    y += my;
+    vx += fxTravel(ax, dtMs);
+    vy += fxTravel(ay, dtMs);
+    if (dx) *dx = mx;
+    if (dy) *dy = my;
+  }
+};
+
+// Axis-aligned box, edges exclusive: two boxes that only touch don't overlap
+struct FxBox {
+  fx x, y, w, h;
+};
+
+inline bool fxOverlap(const FxBox &a, const FxBox &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+// Narrows [lo, hi] (Q16 fractions of the step) to when a span of length aw
+// at a, moving by d, overlaps one of length bw at b
+inline bool fxSweepAxis(fx a, fx aw, fx b, fx bw, fx d, int32_t &lo, int32_t &hi) {
+  if (!d) return a < b + bw && b < a + aw;
+  int64_t enter = ((int64_t)(b - a - aw) << 16) / d;
+  int64_t leave = ((int64_t)(b + bw - a) << 16) / d;
+  if (d < 0) {
+    int64_t t = enter;
+    enter = leave;
+    leave = t;
+  }
+  if (enter > lo) lo = enter;
+  if (leave < hi) hi = leave;
+  return lo < hi;
+}
+
+// Swept test: a and b are where the boxes ended the step, (adx, ady) and
+// (bdx, bdy) how far they moved in it. Returns when in the step they first
+// overlapped, as a Q16 fraction (0 if they already did at its start), or -1
+// if they never did, however far they moved.
+inline int32_t fxSweep(const FxBox &a, fx adx, fx ady, const FxBox &b, fx bdx, fx bdy) {
+  // Most pairs are nowhere near each other: reject on the boxes' swept
+  // bounds before paying for the divisions
+  if (min(a.x, a.x - adx) >= max(b.x, b.x - bdx) + b.w || min(b.x, b.x - bdx) >= max(a.x, a.x - adx) + a.w ||
+      min(a.y, a.y - ady) >= max(b.y, b.y - bdy) + b.h || min(b.y, b.y - bdy) >= max(a.y, a.y - ady) + a.h)
+    return -1;
+  int32_t lo = 0, hi = 1 << 16;
+  fx dx = adx - bdx, dy = ady - bdy;
+  if (!fxSweepAxis(a.x - adx, a.w, b.x - bdx, b.w, dx, lo, hi)) return -1;
+  if (!fxSweepAxis(a.y - ady, a.h, b.y - bdy, b.h, dy, lo, hi)) return -1;
+  return lo;
+}
+
+#endif
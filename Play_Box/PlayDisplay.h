@@ -0,0 +1,182 @@
+#ifndef PLAY_DISPLAY_H
+#define PLAY_DISPLAY_H
+
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "PageFlush.h"
+#include "FlushPipe.h"
+#include "Profiler.h"
+
+#ifdef I2C_BUFFER_LENGTH
+#define WIRE_CHUNK (I2C_BUFFER_LENGTH - 1)
+#else
+#define WIRE_CHUNK 31
+#endif
+
+#define WIRE_CLOCK 400000   // SSD1306 fast mode
+
+// The controller needs two panel frames between content scroll commands;
+// at the oscillator setting Adafruit_SSD1306 uses that is about 10 ms.
+// The flush task may sleep through a few of them per frame; flushing
+// inline in display() never waits.
+#define SSD_SCROLL_GAP_US  10000
+#define SSD_SCROLL_WAIT_US 30000
+
+class WireBus : public DisplayBus {
+public:
+  WireBus(TwoWire *twi, uint8_t addr) : twi(twi), addr(addr) {}
+
+  void setAddress(uint8_t a) { addr = a; }
+
+  // Adafruit_SSD1306 only switches to fast mode inside its own transfers
+  void begin() { twi->setClock(WIRE_CLOCK); }
+
+  void command(const uint8_t *cmds, uint8_t n) override {
+    twi->beginTransmission(addr);
+    twi->write((uint8_t)0x00);
+    twi->write(cmds, n);
+    twi->endTransmission();
+    bytesSent += 2 + n;
+  }
+
+  void data(const uint8_t *bytes, uint16_t n) override {
+    while (n) {
+      uint16_t chunk = n > WIRE_CHUNK ? WIRE_CHUNK : n;
+      twi->beginTransmission(addr);
+      twi->write((uint8_t)0x40);
+      twi->write(bytes, chunk);
+      twi->endTransmission();
+      bytesSent += 2 + chunk;
+      bytes += chunk;
+      n -= chunk;
+    }
+  }
+
+  uint32_t nowUs() override { return micros(); }
+  void waitUs(uint32_t us) override { vTaskDelay(pdMS_TO_TICKS((us + 999) / 1000)); }
+
+private:
+  TwoWire *twi;
+  uint8_t addr;
+};
+
+// Drop-in for Adafruit_SSD1306: display() pushes only the columns that
+// changed since the last push instead of the whole 512-byte buffer.
+//
+// After beginAsync() the push happens on a task on the other core:
+// display() copies the frame into a FlushPipe and returns, so the game can
+// build the next frame while this one goes over I2C. Commands sent with
+// ssd1306_command() meanwhile are safe (Wire locks per transaction); call
+// sync() first when the panel must show the latest frame, e.g. before it is
+// switched on or off.
+//
+// Scroll layers hand bands of the panel to the controller's content scroll
+// (see PageFlusher): set one up with setScrollLayer(), draw the frame as
+// usual and tell scrollTo() how far the band has moved before display().
+class PlayDisplay : public Adafruit_SSD1306 {
+public:
+  // Fast mode after Adafruit's own transfers too, so an ssd1306_command()
+  // doesn't leave the bus at 100 kHz for the next flush
+  PlayDisplay(uint8_t w, uint8_t h, TwoWire *twi, int8_t rst)
+    : Adafruit_SSD1306(w, h, twi, rst, WIRE_CLOCK, WIRE_CLOCK), wireBus(twi, 0x3C) {
+    flusher.bus = &wireBus;
+    flusher.scrollGapUs = SSD_SCROLL_GAP_US;
+  }
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0x3C,
+             bool reset = true, bool periphBegin = true) {
+    bool ok = Adafruit_SSD1306::begin(vcs, addr, reset, periphBegin);
+    wireBus.setAddress(addr);
+    wireBus.begin();
+    flusher.invalidate();
+    return ok;
+  }
+
+  void display() {
+    if (async) {
+      pipe.present(getBuffer(), &scroll);
+      xTaskNotifyGive(flushTask);
+      return;
+    }
+    PROF_SCOPE(PROF_FLUSH);
+    flusher.flush(getBuffer(), &scroll);
+  }
+
+  void setScrollLayer(uint8_t i, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    scroll.layer[i] = { true, p0, p1, c0, c1, scroll.layer[i].offset };
+  }
+  void scrollTo(uint8_t i, int32_t offset) { scroll.layer[i].offset = offset; }
+  void clearScroll() { memset(&scroll, 0, sizeof(scroll)); }
+  const FrameScroll &scrollState() const { return scroll; }
+
+  bool beginAsync(int core = 0) {
+    if (!flushTask && xTaskCreatePinnedToCore(flushLoop, "flush", 3072, this, 2, &flushTask, core) != pdPASS)
+      return false;
+    flusher.scrollWaitUs = SSD_SCROLL_WAIT_US;
+    async = true;
+    return true;
+  }
+
+  // Back to flushing inside display(); the task stays parked
+  void endAsync() {
+    sync();
+    async = false;
+    flusher.scrollWaitUs = 0;
+  }
+
+  // Waits until everything presented so far is on the panel
+  void sync() {
+    while (async && (pipe.pending() || flushing.load())) vTaskDelay(1);
+  }
+
+  // Resend everything on the next display(), e.g. after the panel lost RAM
+  void invalidate() {
+    if (async) invalidatePending.store(true);
+    else flusher.invalidate();
+  }
+
+  // Only while not async
+  void setBus(DisplayBus *bus) { flusher.bus = bus; flusher.invalidate(); }
+
+  uint16_t lastFlushBytes() const { return flusher.frameBytes; }
+  uint16_t lastScrollSteps() const { return flusher.scrollSteps; }
+  uint32_t scrollResends() const { return flusher.scrollResends; }
+  uint32_t framesPresented() const { return pipe.presented; }
+  uint32_t framesDropped() const { return pipe.dropped.load(); }
+  uint32_t framesFlushed() const { return flushed.load(); }
+
+private:
+  WireBus wireBus;
+  PageFlusher flusher;
+  FlushPipe pipe;
+  FrameScroll scroll = {};
+  TaskHandle_t flushTask = nullptr;
+  bool async = false;
+  std::atomic<bool> flushing{false}, invalidatePending{false};
+  std::atomic<uint32_t> flushed{0};
+
+  static void flushLoop(void *arg) {
+    PlayDisplay *d = (PlayDisplay *)arg;
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      d->drain();
+    }
+  }
+
+  // Flush task: send the newest frame until nothing new has arrived
+  void drain() {
+    flushing.store(true);
+    if (invalidatePending.exchange(false)) flusher.invalidate();
+    const FrameScroll *s;
+    while (const uint8_t *fb = pipe.take(&s)) {
+      PROF_SCOPE(PROF_FLUSH);
+      flusher.flush(fb, s);
+      flushed.fetch_add(1, std::memory_order_relaxed);
+    }
+    flushing.store(false);
+  }
+};
+
+#endif
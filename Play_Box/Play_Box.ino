@@ -1,5 +1,10 @@
+// Uncomment to stream phase histograms over Serial (see Profiler.h)
+// #define PLAYBOX_PROFILE
+// Uncomment to keep each game's last session in flash; launching a game with
+// MENU held replays it (see Replay.h)
+// #define PLAYBOX_REPLAY
+
 #include <WiFi.h>
-#include <NTPClient.h>
 #include <WiFiUdp.h>
 #include <Wire.h>
 #include <Adafruit_SSD1306.h>
@@ -13,9 +18,22 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
+#include "PlayDisplay.h"
+#include "Scheduler.h"
+#include "Buttons.h"
+#include "Standby.h"
+#include "NtpSync.h"
+#include "WifiLink.h"
+#include "LastTime.h"
+#include "ClockFace.h"
+#include "TempHistory.h"
+#include "TrendScreen.h"
+#include "Menu.h"
 #include "SnakeGame.h"
+#include "SnakeBot.h"
 #include "JumpGame.h"
 #include "ShootingGame.h"
+#include "BulletHellGame.h"
 
 #define OLED_RESET     -1
 #define SCREEN_WIDTH   128
@@ -29,22 +47,58 @@
 #define BTN_DOWN       7
 #define BTN_MENU       8
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+PlayDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 OneWire oneWire(TEMP_PIN);
 DallasTemperature sensors(&oneWire);
 WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, "pool.ntp.org", 19800);  // IST offset
+AsyncNtp timeClient(ntpUDP, "pool.ntp.org", 19800);  // IST offset
 Preferences preferences;
+Preferences clockPrefs;
+Preferences tempPrefs;
+#ifdef PLAYBOX_REPLAY
+Preferences replayPrefs;
+#endif
 
 BLECharacteristic *pSSID;
 BLECharacteristic *pPASS;
 bool newCredsReceived = false;
 String ssidReceived = "", passReceived = "";
 
-int currentSelection = 0;
-const char *games[] = { "Snake Game", "Jump Game", "Shooting Game", "Back" };
-const int numGames = sizeof(games) / sizeof(games[0]);
+// Adding a game is one line here. Every menu ends with a Back row.
+constexpr MenuEntry snakeMenu[] = {
+  menuItem("Snake Game", &ICON_SNAKE, runSnakeGame),
+  menuItem("Snake 1px", &ICON_SNAKE, runSnakeFineGame),
+};
+
+constexpr MenuEntry jumpMenu[] = {
+  menuItem("Jump Game", &ICON_JUMP, runJumpGame),
+  menuItem("Jump Scroll", &ICON_JUMP, runJumpScrollGame),
+};
+
+constexpr MenuEntry mainMenu[] = {
+  subMenu("Snake", &ICON_SNAKE, snakeMenu),
+  subMenu("Jump", &ICON_JUMP, jumpMenu),
+  menuItem("Shooting Game", &SPRITE_PLANE, runShootingGame),
+  menuItem("Bullet Hell", &SPRITE_ENEMY_B, runBulletHellGame),
+};
+
 bool inClockScreen = true;
+bool inTrendScreen = false;   // SELECT on the clock
+const MenuEntry *pendingGame = nullptr;  // set by the menu, run from loop()
+bool launching = false;    // "Launching" splash is up
+bool replayWanted = false; // MENU was held at launch
+bool attractOn = false;    // menu idle: the snake plays itself from loop()
+
+// Staged boot: setup() only does what the first clock frame needs; the
+// rest comes up one stage per bootTask() run
+int bootStage = 0;
+bool sensorsReady = false;
+bool bleReady = false;
+unsigned long bootFirstFrameMs = 0;
+
+void bootMark(const char *stage) {
+  Serial.printf("boot %5lu ms  %s\n", millis(), stage);
+}
 
 // Sleep Logic
 unsigned long lastInteraction = 0;
@@ -78,163 +132,340 @@ void setupBLE() {
   BLEDevice::getAdvertising()->start();
 }
 
-void connectWiFi() {
-  String savedSSID = preferences.getString("ssid", "");
-  String savedPASS = preferences.getString("pass", "");
-  if (savedSSID != "") {
-    WiFi.begin(savedSSID.c_str(), savedPASS.c_str());
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
-      delay(100);
+long clockDay = -1;
+char clockDate[20];
+
+void drawClock() {
+  PROF_SCOPE(PROF_RENDER);
+  menuInvalidate();
+  trendInvalidate();
+  unsigned long epoch = timeClient.getEpochTime();
+  if (timeClient.hasTime()) rememberTime(timeClient.unixMs());  // not uptime posing as 1970
+
+  int hour = (epoch % 86400L) / 3600;
+  int h12 = hour % 12;
+  if (h12 == 0) h12 = 12;
+  char timeBuf[CLOCK_TEXT_MAX];
+  snprintf(timeBuf, sizeof(timeBuf), "%2d:%02d:%02d %s", h12, (int)(epoch % 3600) / 60,
+           (int)(epoch % 60), hour >= 12 ? "PM" : "AM");
+  clockFaceTime(display, timeBuf);
+
+  // Date text only changes at midnight
+  long day = epoch / 86400L;
+  if (day != clockDay) {
+    time_t rawTime = epoch;
+    struct tm *ti = localtime(&rawTime);
+    strftime(clockDate, sizeof(clockDate), "%d %b (%a)", ti);
+    clockDay = day;
   }
+  clockFaceDate(display, clockDate);
+
+  char tempBuf[12] = "--.-C";
+  if (tempNow != TEMP_NONE) snprintf(tempBuf, sizeof(tempBuf), "%.1fC", tempNow / 10.0f);
+  clockFaceTemp(display, tempBuf);
+
+  clockFaceDone(display);
+  display.display();
 }
 
-void setup() {
-  Serial.begin(115200);
-  Wire.begin(SDA_PIN, SCL_PIN);
-  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
-  sensors.begin();
+void drawMenu() {
+  PROF_SCOPE(PROF_RENDER);
+  clockFaceInvalidate();
+  trendInvalidate();
+  menuDraw(display);
+  display.display();
+}
 
-  preferences.begin("wifi", false);
-  setupBLE();
-  connectWiFi();
+void drawTrend() {
+  PROF_SCOPE(PROF_RENDER);
+  clockFaceInvalidate();
+  menuInvalidate();
+  trendDraw(display);
+  display.display();
+}
 
-  if (WiFi.status() == WL_CONNECTED) {
-    timeClient.begin();
-    timeClient.update();
-  }
+// Panel off; loop() stops running tasks and light-sleeps until a button
+void enterStandby() {
+  display.sync();
+  display.ssd1306_command(SSD1306_DISPLAYOFF);
+  displaySleeping = true;
+  standbyBegin();
+}
 
-  pinMode(BTN_SELECT, INPUT);
-  pinMode(BTN_UP, INPUT);
-  pinMode(BTN_DOWN, INPUT);
-  pinMode(BTN_MENU, INPUT);
+// The waking press does nothing else. The clock is redrawn before the panel
+// comes back so the first visible frame is current.
+void leaveStandby() {
+  buttonsResync();
+  displaySleeping = false;
+  lastInteraction = millis();
+  if (inClockScreen) drawClock();
+  else if (inTrendScreen) drawTrend();
+  display.sync();
+  display.ssd1306_command(SSD1306_DISPLAYON);
+}
 
-  lastInteraction = millis();  // Start sleep timer
+void saveWiFi() {
+  wifiStoreSave(preferences);
 }
 
-void drawClock() {
-  sensors.requestTemperatures();
-  float tempC = sensors.getTempCByIndex(0);
-
-  if (WiFi.status() == WL_CONNECTED) timeClient.update();
-
-  display.clearDisplay();
-  display.setTextColor(SSD1306_WHITE);
-
-  display.setFont(&FreeSans9pt7b);
-  display.setCursor(0, 14);
-  String timeStr = timeClient.getFormattedTime();
-  int hour = timeStr.substring(0, 2).toInt();
-  String ampm = "AM";
-  if (hour >= 12) { ampm = "PM"; if (hour > 12) hour -= 12; }
-  if (hour == 0) hour = 12;
-  timeStr = (hour < 10 ? " " : "") + String(hour) + timeStr.substring(2) + " " + ampm;
-  display.print(timeStr);
-
-  display.setFont();
-  display.setCursor(0, 24);
-  time_t rawTime = timeClient.getEpochTime();
-  struct tm *ti = localtime(&rawTime);
-  char dateBuf[20];
-  strftime(dateBuf, sizeof(dateBuf), "%d %b (%a)", ti);
-  display.print(dateBuf);
-
-  display.setCursor(96, 24);
-  display.print(String(tempC, 1) + "C");
+// NTP runs only while the link is up; a new link syncs straight away and the
+// clock keeps running on the local clock in between
+void wifiChanged(WifiState state) {
+  if (state == WIFI_CONNECTED)
+    Serial.printf("%lu wifi: connected to %s in %lu ms (%s)\n", millis(), wifiNet->ssid, (unsigned long)wifiNet->lastMs,
+                  !wifiDirect ? "scan" : wifiStaticIp ? "cached AP and lease" : "cached AP");
+  else
+    Serial.printf("%lu wifi: %s\n", millis(), wifiStateName(state));
+  if (state == WIFI_CONNECTED && !timeClient.isTimeSet()) bootMark("wifi connected");
+  if (state == WIFI_CONNECTED) timeClient.begin();
+  else timeClient.end();
+}
 
-  display.display();
+void wifiTask() {
+  wifiPoll();
 }
 
-void drawMenu() {
-  display.clearDisplay();
-  display.setFont();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-
-  int startIdx = currentSelection;
-  if (startIdx > numGames - 3) startIdx = numGames - 3;
-  if (startIdx < 0) startIdx = 0;
-
-  for (int i = 0; i < 3 && (startIdx + i) < numGames; i++) {
-    int itemIndex = startIdx + i;
-    display.setCursor(0, i * 10);
-    if (itemIndex == currentSelection) display.print("> ");
-    else display.print("  ");
-    display.print(games[itemIndex]);
+void ntpTask() {
+  if (wifiState != WIFI_CONNECTED || !timeClient.update()) return;
+  persistTime(clockPrefs, timeClient.unixMs());
+  if (timeClient.syncs == 1) bootMark("ntp synced");
+}
+
+void credsTask() {
+  if (!newCredsReceived) return;
+  newCredsReceived = false;
+  wifiAdd(ssidReceived, passReceived);
+}
+
+void clockTask() {
+  if (pendingGame) return;
+  if (inClockScreen) drawClock();
+  else if (inTrendScreen) drawTrend();
+}
+
+// Collects the conversion started last time and starts the next one. Runs
+// every second, and on the once-a-minute wake in standby.
+void tempTask() {
+  if (!sensors.isConversionComplete()) return;
+  float c = sensors.getTempCByIndex(0);
+  if (c != DEVICE_DISCONNECTED_C) tempReading(c, millis());
+  sensors.requestTemperatures();
+  if (tempSaveDue()) tempSave(tempPrefs);
+}
+
+// Network first (NTP follows the link), then the temperature sensor, then
+// BLE provisioning. Without saved credentials BLE is the only way onto the
+// network, so it comes up with the network stage.
+void bootTask() {
+  switch (bootStage++) {
+    case 0:
+      if (!wifiStart()) {
+        setupBLE();
+        bleReady = true;
+        bootMark("ble (no saved network)");
+      }
+      bootMark("network started");
+      break;
+    case 1:
+      sensors.begin();
+      sensors.setWaitForConversion(false);
+      sensors.requestTemperatures();
+      sensorsReady = true;
+      scheduleTask(tempTask, 1000, 1000);
+      bootMark("sensors");
+      break;
+    case 2:
+      if (!bleReady) {
+        setupBLE();
+        bleReady = true;
+        bootMark("ble");
+      }
+      return;
   }
-  display.display();
+  scheduleTask(bootTask, 50);  // let input and the clock run in between
 }
 
-void loop() {
-  if (newCredsReceived) {
-    WiFi.begin(ssidReceived.c_str(), passReceived.c_str());
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
-      delay(100);
-    if (WiFi.status() == WL_CONNECTED) {
-      preferences.putString("ssid", ssidReceived);
-      preferences.putString("pass", passReceived);
-      timeClient.begin();
-    }
-    newCredsReceived = false;
+void launchTask() {
+  launching = false;
+}
+
+void inputTask() {
+  // runGame() keeps the scheduler going between steps; presses during a
+  // game (or attract mode) are the game's to see
+  if (attractOn || launching || pendingGame) return;
+
+  ButtonEvent e;
+  bool menuPressed = false, selectPressed = false, upPressed = false, downPressed = false;
+  bool any = false;
+  while (nextButtonEvent(e)) {
+    if (e.type != BUTTON_PRESS) continue;
+    any = true;
+    if (e.pin == BTN_MENU) menuPressed = true;
+    if (e.pin == BTN_SELECT) selectPressed = true;
+    if (e.pin == BTN_UP) upPressed = true;
+    if (e.pin == BTN_DOWN) downPressed = true;
   }
 
-  // Wake on any button
-  bool anyButtonPressed = !digitalRead(BTN_MENU) || !digitalRead(BTN_SELECT) || !digitalRead(BTN_UP) || !digitalRead(BTN_DOWN);
-  if (anyButtonPressed) {
-    lastInteraction = millis();
-    if (displaySleeping) {
-      display.ssd1306_command(SSD1306_DISPLAYON);
-      displaySleeping = false;
-    }
+  if (any) lastInteraction = millis();
+
+  // Standby after timeout
+  if (millis() - lastInteraction > sleepTimeout) {
+    enterStandby();
+    return;
+  }
+
+  if (!inClockScreen && !inTrendScreen && millis() - lastInteraction > ATTRACT_IDLE_MS) {
+    attractOn = true;
+    return;
   }
 
   if (inClockScreen) {
-    drawClock();
-    if (!digitalRead(BTN_MENU)) {
+    if (menuPressed) {
       inClockScreen = false;
       drawMenu();
-      delay(300);
-    }
-    delay(1000);
-  } else {
-    if (!digitalRead(BTN_UP)) {
-      currentSelection--;
-      if (currentSelection < 0) currentSelection = numGames - 1;
-      drawMenu();
-      delay(200);
+    } else if (selectPressed) {
+      inClockScreen = false;
+      inTrendScreen = true;
+      drawTrend();
     }
-    if (!digitalRead(BTN_DOWN)) {
-      currentSelection++;
-      if (currentSelection >= numGames) currentSelection = 0;
-      drawMenu();
-      delay(200);
+    return;
+  }
+
+  // Trend: UP/DOWN change the range, SELECT or MENU go back to the clock
+  if (inTrendScreen) {
+    if (selectPressed || menuPressed) {
+      inTrendScreen = false;
+      inClockScreen = true;
+      drawClock();
+    } else if (upPressed || downPressed) {
+      trendNextRange(upPressed ? -1 : 1);
+      drawTrend();
     }
+    return;
+  }
+
+  if (upPressed) {
+    menuMove(-1);
+    drawMenu();
+  }
+  if (downPressed) {
+    menuMove(1);
+    drawMenu();
+  }
 
-    if (!digitalRead(BTN_SELECT)) {
-      if (currentSelection == 3) {
+  if (selectPressed) {
+    const MenuEntry *e;
+    switch (menuSelect(&e)) {
+      case MENU_EXIT:
         inClockScreen = true;
-      } else {
+        drawClock();
+        break;
+      case MENU_NONE:
+        drawMenu();
+        break;
+      case MENU_RUN:
         display.clearDisplay();
         display.setCursor(0, 12);
-        display.print(games[currentSelection]);
+        display.print(e->name);
         display.display();
-        delay(1000);
-
-        switch (currentSelection) {
-          case 0: runSnakeGame(); break;
-          case 1: runJumpGame(); break;
-          case 2: runShootingGame(); break;
-        }
-      }
-      drawMenu();
-      delay(200);
+        launching = true;
+        pendingGame = e;
+        replayWanted = buttonDown(BTN_MENU);
+        scheduleTask(launchTask, 1000);
+        break;
     }
   }
+}
+
+void setup() {
+  Serial.begin(115200);
+  bootMark("setup");
+  Wire.begin(SDA_PIN, SCL_PIN);
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  clockFaceBegin(display, 14, 96);
+
+  // Clock from the last known time until NTP answers
+  preferences.begin("wifi", false);
+  wifiStoreLoad(preferences);
+  clockPrefs.begin("clock", false);
+  tempPrefs.begin("temp", false);
+  tempLoad(tempPrefs);
+#ifdef PLAYBOX_REPLAY
+  replayPrefs.begin("replay", false);
+#endif
+  uint64_t lastMs = restoreTime(clockPrefs);
+  if (lastMs) timeClient.setTime(lastMs);
+  drawClock();
+  bootFirstFrameMs = millis();
+  bootMark(lastMs ? "first frame (last known time)" : "first frame (no time yet)");
+  display.beginAsync();  // from here on frames go over I2C from the other core
+
+  menuOpen(mainMenu);
+  wifiOnChange = wifiChanged;
+  wifiOnSave = saveWiFi;
+  buttonsBegin();
+
+  scheduleTask(inputTask, 0, 10);
+  scheduleTask(clockTask, 1000, 1000);
+  scheduleTask(ntpTask, 0, 10);  // replies are timed at poll resolution
+  scheduleTask(credsTask, 0, 100);
+  scheduleTask(wifiTask, 0, 100);
+  scheduleTask(bootTask, 0);
+
+  lastInteraction = millis();  // Start sleep timer
+}
+
+// Seeds the game's PRNG. With PLAYBOX_REPLAY the session is also recorded,
+// or the saved one is played back if asked for.
+void gameStarting(const char *name) {
+#ifdef PLAYBOX_REPLAY
+  if (replayWanted && replayLoad(replayPrefs, name)) replayPlay();
+  else replayRecord(name, esp_random());
+#else
+  gameSeed(esp_random());
+#endif
+}
+
+void gameEnded() {
+#ifdef PLAYBOX_REPLAY
+  bool recorded = replayMode == REPLAY_RECORD;
+  replayStop(display.getBuffer(), FLUSH_BYTES);
+  if (recorded) replaySave(replayPrefs);
+#endif
+}
+
+void loop() {
+  if (displaySleeping) {
+    if (standbySleep()) leaveStandby();
+    else if (sensorsReady) tempTask();
+    return;
+  }
+
+  {
+    PROF_SCOPE(PROF_TASKS);
+    runTasks();
+  }
+  PROF_POLL();
+
+  if (pendingGame && !launching) {
+    gameStarting(pendingGame->name);
+    menuRun(pendingGame);
+    gameEnded();
+    pendingGame = nullptr;
+    lastInteraction = millis();
+    clearButtonEvents();
+    menuInvalidate();
+    drawMenu();
+  }
 
-  // Sleep screen after timeout
-  if (!displaySleeping && (millis() - lastInteraction > sleepTimeout)) {
-    display.ssd1306_command(SSD1306_DISPLAYOFF);
-    displaySleeping = true;
+  // Runs into the standby timeout unless a press ends it first; the menu is
+  // put back either way, so waking from standby shows it
+  if (attractOn) {
+    gameSeed(esp_random());
+    if (runAttract(lastInteraction + sleepTimeout)) lastInteraction = millis();
+    attractOn = false;
+    clearButtonEvents();
+    menuInvalidate();
+    drawMenu();
   }
 }
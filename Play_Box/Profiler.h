@@ -0,0 +1,126 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Phase profiler. PROF_SCOPE(phase) times the rest of the enclosing block in
+// CPU cycles and adds it to that phase's histogram; PROF_POLL() streams the
+// histograms over Serial every PROF_DUMP_MS and starts new ones. Decode the
+// stream with host/prof_decode.cpp.
+//
+// Off unless PLAYBOX_PROFILE is defined (before the first include of this
+// file, or with -DPLAYBOX_PROFILE); then the macros expand to nothing.
+//
+// Histograms are log-bucketed: PROF_SUB buckets per power of two, so any
+// percentile is known to within 2^(1/PROF_SUB) (about 19%).
+//
+// Scopes run on both cores once the flush is async, so the histograms are
+// atomics and a dump takes each counter with an exchange: every sample
+// lands in one window or the next, none is lost or half-counted.
+//
+// Dump frame, little-endian:
+//   'P' 'F' version(1) phases(1) cpuMhz(2) windowMs(4)
+//   per phase: id(1) count(4) max(4) used(1), then used x [bucket(1) n(2)]
+//   sum(1): low byte of the sum of every byte before it
+
+enum ProfPhase {
+  PROF_INPUT,     // button polling
+  PROF_UPDATE,    // one game step
+  PROF_MOVE,      // moveObjects / moveSnake / bhMove
+  PROF_COLLIDE,   // checkCollisions / bhCollide
+  PROF_RENDER,    // draw* (includes the flush)
+  PROF_FLUSH,     // display.display()
+  PROF_TASKS,     // one runTasks() pass in loop()
+  PROF_PHASES
+};
+
+#define PROF_SUB_BITS 2
+#define PROF_SUB      (1 << PROF_SUB_BITS)
+#define PROF_BUCKETS  (32 * PROF_SUB)
+#define PROF_VERSION  1
+
+#ifdef PLAYBOX_PROFILE
+
+#define PROF_DUMP_MS 5000
+
+struct ProfHist {
+  std::atomic<uint32_t> count, max;
+  std::atomic<uint32_t> n[PROF_BUCKETS];   // sent saturated to 16 bits
+};
+
+ProfHist profHist[PROF_PHASES];
+unsigned long profWindowStart = 0;
+
+inline uint8_t profBucket(uint32_t cycles) {
+  if (cycles < PROF_SUB) return cycles;
+  int top = 31 - __builtin_clz(cycles);
+  return (top - PROF_SUB_BITS + 1) * PROF_SUB + ((cycles >> (top - PROF_SUB_BITS)) & (PROF_SUB - 1));
+}
+
+inline void profAdd(uint8_t phase, uint32_t cycles) {
+  ProfHist &h = profHist[phase];
+  h.count.fetch_add(1, std::memory_order_relaxed);
+  uint32_t m = h.max.load(std::memory_order_relaxed);
+  while (cycles > m && !h.max.compare_exchange_weak(m, cycles, std::memory_order_relaxed)) {}
+  h.n[profBucket(cycles)].fetch_add(1, std::memory_order_relaxed);
+}
+
+struct ProfScope {
+  uint8_t phase;
+  uint32_t start;
+  ProfScope(uint8_t phase) : phase(phase), start(ESP.getCycleCount()) {}
+  ~ProfScope() { profAdd(phase, ESP.getCycleCount() - start); }
+};
+
+struct ProfOut {
+  uint8_t sum = 0;
+  void put(uint8_t b) { Serial.write(b); sum += b; }
+  void put16(uint16_t v) { put(v); put(v >> 8); }
+  void put32(uint32_t v) { put16(v); put16(v >> 16); }
+};
+
+void profDump() {
+  ProfOut o;
+  o.put('P');
+  o.put('F');
+  o.put(PROF_VERSION);
+  o.put(PROF_PHASES);
+  o.put16(getCpuFrequencyMhz());
+  o.put32(millis() - profWindowStart);
+  for (int p = 0; p < PROF_PHASES; p++) {
+    ProfHist &h = profHist[p];
+    uint32_t n[PROF_BUCKETS];
+    uint8_t used = 0;
+    for (int b = 0; b < PROF_BUCKETS; b++) used += (n[b] = h.n[b].exchange(0, std::memory_order_relaxed)) != 0;
+    o.put(p);
+    o.put32(h.count.exchange(0, std::memory_order_relaxed));
+    o.put32(h.max.exchange(0, std::memory_order_relaxed));
+    o.put(used);
+    for (int b = 0; b < PROF_BUCKETS; b++)
+      if (n[b]) {
+        o.put(b);
+        o.put16(n[b] > 0xFFFF ? 0xFFFF : n[b]);
+      }
+  }
+  Serial.write(o.sum);
+  profWindowStart = millis();
+}
+
+void profPoll() {
+  if (millis() - profWindowStart >= PROF_DUMP_MS) profDump();
+}
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b)  PROF_CAT2(a, b)
+#define PROF_SCOPE(phase) ProfScope PROF_CAT(profScope, __LINE__)(phase)
+#define PROF_POLL() profPoll()
+
+#else
+
+#define PROF_SCOPE(phase)
+#define PROF_POLL()
+
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stddef.h>
+#include "Buttons.h"
+#include "GameRng.h"
+
+// Record and replay of game sessions. A session is the PRNG seed plus the
+// four button levels at every game step, run-length encoded: one uint16_t
+// per run, the mask in the top 4 bits and length-1 in the low 12.
+//
+// While recording or replaying, replayStep() is the only input the game
+// sees. It turns the step's mask into press/release/hold events in the
+// Buttons.h queue, and the pins are ignored. A recording samples the
+// debounced buttons once per step. A press released within the same step
+// is stretched to one step, so playback shows the game exactly what it saw.
+//
+// Stored log, little-endian: the ReplayLog header followed by `runs` runs.
+
+#define REPLAY_MAGIC    0x31504C52u  // "RPL1"
+#define REPLAY_MAX_RUNS 1024
+#define REPLAY_RUN_MAX  4096         // steps per run
+
+enum ReplayMode : uint8_t { REPLAY_OFF, REPLAY_RECORD, REPLAY_PLAY };
+
+struct ReplayLog {
+  uint32_t magic;
+  char game[16];
+  uint32_t seed;
+  uint32_t steps;
+  uint32_t check;      // FNV-1a of the framebuffer when the session ended
+  uint16_t runs;
+  uint8_t startMask;   // buttons already down when it started
+  uint8_t complete;    // 0 if the run table filled up
+  uint16_t run[REPLAY_MAX_RUNS];
+};
+
+ReplayLog replayLog;
+ReplayMode replayMode = REPLAY_OFF;
+ButtonState replayLive[BUTTON_COUNT];  // real debouncer state while recording
+uint16_t replayPos, replayLeft;         // playback cursor
+uint32_t replayDone;                    // steps played back
+
+inline bool replayActive() { return replayMode != REPLAY_OFF; }
+
+inline size_t replayBytes() { return offsetof(ReplayLog, run) + replayLog.runs * sizeof(uint16_t); }
+
+uint32_t replayHash(const uint8_t *p, size_t n) {
+  uint32_t h = 2166136261u;
+  while (n--) h = (h ^ *p++) * 16777619u;
+  return h;
+}
+
+uint8_t buttonMask() {
+  uint8_t m = 0;
+  for (int i = 0; i < BUTTON_COUNT; i++) m |= buttonStates[i].down << i;
+  return m;
+}
+
+// Game-visible state from a mask, as if the buttons had been down all along
+void replaySetStates(uint8_t mask) {
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    bool down = mask >> i & 1;
+    buttonStates[i] = { down, down, true, 0 };
+  }
+  ButtonEvent e;
+  while (buttonEvents.pop(e)) {}
+  buttonsFed = true;
+}
+
+void replayRecord(const char *game, uint32_t seed) {
+  memset(&replayLog, 0, offsetof(ReplayLog, run));
+  replayLog.magic = REPLAY_MAGIC;
+  strncpy(replayLog.game, game, sizeof(replayLog.game) - 1);
+  replayLog.seed = seed;
+  replayLog.complete = 1;
+  pollButtons();
+  memcpy(replayLive, buttonStates, sizeof(replayLive));
+  replayLog.startMask = buttonMask();
+  replaySetStates(replayLog.startMask);
+  gameSeed(seed);
+  replayMode = REPLAY_RECORD;
+}
+
+// Plays back replayLog (filled by replayRecord or replayLoad)
+void replayPlay() {
+  replayPos = 0;
+  replayLeft = 0;
+  replayDone = 0;
+  replaySetStates(replayLog.startMask);
+  gameSeed(replayLog.seed);
+  replayMode = REPLAY_PLAY;
+}
+
+// This step's buttons from the real ones: debounced level, plus anything
+// pressed since the last step
+uint8_t replaySample() {
+  ButtonState fed[BUTTON_COUNT];
+  memcpy(fed, buttonStates, sizeof(fed));
+  memcpy(buttonStates, replayLive, sizeof(fed));
+  buttonsFed = false;
+  pollButtons();
+  buttonsFed = true;
+  uint8_t mask = buttonMask();
+  memcpy(replayLive, buttonStates, sizeof(fed));
+  memcpy(buttonStates, fed, sizeof(fed));
+
+  ButtonEvent e;
+  while (buttonEvents.pop(e))
+    if (e.type == BUTTON_PRESS) mask |= 1 << (e.pin - BUTTON_FIRST_PIN);
+  return mask;
+}
+
+void replayAppend(uint8_t mask) {
+  ReplayLog &l = replayLog;
+  if (!l.complete) return;
+  uint16_t *last = l.runs ? &l.run[l.runs - 1] : nullptr;
+  if (last && *last >> 12 == mask && (*last & 0xFFF) < REPLAY_RUN_MAX - 1) (*last)++;
+  else if (l.runs < REPLAY_MAX_RUNS) l.run[l.runs++] = mask << 12;
+  else l.complete = 0;
+  l.steps++;
+}
+
+// Next mask from the log, or false at its end
+bool replayNext(uint8_t &mask) {
+  if (!replayLeft) {
+    if (replayPos >= replayLog.runs) return false;
+    replayLeft = (replayLog.run[replayPos++] & 0xFFF) + 1;
+  }
+  replayLeft--;
+  replayDone++;
+  mask = replayLog.run[replayPos - 1] >> 12;
+  return true;
+}
+
+void replayFeed(uint8_t mask, uint32_t nowMs) {
+  uint32_t t = nowMs * 1000UL;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    bool down = mask >> i & 1;
+    if (down != buttonStates[i].down) acceptButton(i, down, t);
+    else checkHold(i, t);
+  }
+}
+
+// Once per game step, before update(); nowMs is game time
+void replayStep(uint32_t nowMs) {
+  if (!replayActive()) return;
+  ButtonEvent e;
+  while (buttonEvents.pop(e)) {}  // whatever the last step left unread
+
+  uint8_t mask;
+  if (replayMode == REPLAY_RECORD) {
+    mask = replaySample();
+    replayAppend(mask);
+  } else if (!replayNext(mask)) {
+    // Log ran out before the game ended: hand the buttons back
+    replayMode = REPLAY_OFF;
+    buttonsFed = false;
+    buttonsResync();
+    return;
+  }
+  replayFeed(mask, nowMs);
+}
+
+// Ends recording or playback. fb is the last frame drawn; returns false if
+// a playback didn't end on the recorded frame.
+bool replayStop(const uint8_t *fb, size_t n) {
+  ReplayMode mode = replayMode;
+  if (mode == REPLAY_OFF) return true;
+  replayMode = REPLAY_OFF;
+  buttonsFed = false;
+  buttonsResync();
+  uint32_t h = replayHash(fb, n);
+  if (mode == REPLAY_RECORD) {
+    replayLog.check = h;
+    Serial.printf("replay: recorded %lu steps in %u runs (%u bytes)%s\n", (unsigned long)replayLog.steps,
+                  replayLog.runs, (unsigned)replayBytes(), replayLog.complete ? "" : ", truncated");
+    return true;
+  }
+  bool match = replayDone == replayLog.steps && h == replayLog.check;
+  Serial.printf("replay: played %lu of %lu steps, last frame %s\n", (unsigned long)replayDone,
+                (unsigned long)replayLog.steps, match ? "matches" : "DIFFERS");
+  return match;
+}
+
+// One session per game, keyed by name (NVS keys are at most 15 chars)
+bool replaySave(Preferences &prefs) {
+  if (!replayLog.complete || !replayLog.steps) return false;
+  char key[16];
+  strncpy(key, replayLog.game, 15);
+  key[15] = 0;
+  return prefs.putBytes(key, &replayLog, replayBytes()) == replayBytes();
+}
+
+bool replayLoad(Preferences &prefs, const char *game) {
+  char key[16];
+  strncpy(key, game, 15);
+  key[15] = 0;
+  size_t n = prefs.getBytesLength(key);
+  if (n < offsetof(ReplayLog, run) || n > sizeof(ReplayLog)) return false;
+  prefs.getBytes(key, &replayLog, n);
+  return replayLog.magic == REPLAY_MAGIC && replayBytes() == n;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Cooperative scheduler: tasks are plain functions that must return quickly.
+// runTasks() runs every due task, earliest deadline first. A one-shot task
+// can queue itself again with scheduleTask() while running.
+
+#define MAX_TASKS 12
+
+typedef void (*TaskFn)();
+
+struct Task {
+  TaskFn fn;
+  unsigned long due;
+  unsigned long period;   // 0 = one-shot
+  bool active;
+};
+
+Task tasks[MAX_TASKS];
+
+bool taskDue(const Task &t, unsigned long now) {
+  return t.active && (long)(now - t.due) >= 0;
+}
+
+int scheduleTask(TaskFn fn, unsigned long delayMs, unsigned long periodMs = 0) {
+  for (int i = 0; i < MAX_TASKS; i++)
+    if (!tasks[i].active) {
+      tasks[i] = { fn, millis() + delayMs, periodMs, true };
+      return i;
+    }
+  return -1;
+}
+
+void runTasks() {
+  unsigned long now = millis();
+  for (int n = 0; n < MAX_TASKS; n++) {  // bounded, so zero-delay reschedules can't spin
+    int next = -1;
+    for (int i = 0; i < MAX_TASKS; i++)
+      if (taskDue(tasks[i], now) && (next < 0 || (long)(tasks[i].due - tasks[next].due) < 0))
+        next = i;
+    if (next < 0) return;
+
+    Task &t = tasks[next];
+    TaskFn fn = t.fn;
+    if (t.period) {
+      t.due += t.period;
+      if ((long)(now - t.due) >= 0) t.due = now + t.period;  // fell behind, don't burst
+    } else {
+      t.active = false;
+    }
+    fn();
+  }
+}
+
+#endif
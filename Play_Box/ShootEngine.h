@@ -0,0 +1,316 @@
+#ifndef SHOOT_ENGINE_H
+#define SHOOT_ENGINE_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "Sprites.h"
+#include "Profiler.h"
+#include "GameRng.h"
+#include "Physics.h"
+
+// Shooting game rules shared by the Play_Box menu game and shooting_game.c:
+// stages of enemies, then a boss whose health grows with the stage.
+//
+// Entities live in fixed pools stored as structure-of-arrays. A pool keeps a
+// bitmask of live slots, walked with count-trailing-zeros, and a free list,
+// so spawning is O(1) and each pass costs the live entities plus one word
+// per 32 slots. Capacities are template parameters; raising them costs
+// memory only.
+//
+// Positions and speeds are Physics.h fixed point and scaled by the time
+// since the last step, so play runs at the same speed at any frame rate.
+// Hits are swept over the step: a bullet can't jump over an enemy or an
+// enemy bullet between two frames however fast either one goes.
+
+#define SHOOT_TOP          10    // below the HUD line
+#define SHOOT_PLAYER_X     4
+#define SHOOT_PLAYER_MAX_Y 26
+#define SHOOT_FIRE_MS      250
+#define SHOOT_SPAWN_MS     1000
+#define SHOOT_VOLLEY_MS    1500
+#define SHOOT_BOSS_AT      10    // score that brings the boss
+#define SHOOT_BOSS_X       100
+#define SHOOT_BOSS_SHOT_MS 1200
+#define SHOOT_MAX_DT_MS    100   // a longer gap is played as this much
+
+// Speeds in px/s; the old per-frame speeds at 30 ms frames
+#define SHOOT_PLAYER_SPEED FX(33.3)
+#define SHOOT_BULLET_SPEED FX(66.7)
+#define SHOOT_ESHOT_SPEED  FX(66.7)
+#define SHOOT_BOSS_SPEED   FX(10)
+// Enemies start at 33 px/s; each kill adds a little and each stage more
+#define SHOOT_ENEMY_SPEED  FX(33.3)
+#define SHOOT_ENEMY_SCORE  FX(1.5)
+#define SHOOT_ENEMY_STAGE  FX(8)
+
+template <int N>
+struct EntityPool {
+  static_assert(N > 0 && N < 256, "pool index is a uint8_t");
+  static const int WORDS = (N + 31) / 32;
+
+  fx x[N], y[N];
+  fx vx[N];                // px/s, horizontal only
+  fx dx[N];                // moved in the last step, for swept hits
+  uint8_t tag[N];          // per-kind extra (enemy type)
+  uint32_t live[WORDS];
+  uint8_t next[N];         // free list links
+  uint8_t freeHead;
+  uint8_t count;
+
+  void clear() {
+    memset(live, 0, sizeof(live));
+    for (int i = 0; i < N; i++) next[i] = i + 1;
+    freeHead = 0;
+    count = 0;
+  }
+
+  // Slot index, or -1 when full
+  int add(fx px, fx py, fx v, uint8_t t = 0) {
+    if (freeHead == N) return -1;
+    int i = freeHead;
+    freeHead = next[i];
+    x[i] = px;
+    y[i] = py;
+    vx[i] = v;
+    dx[i] = 0;
+    tag[i] = t;
+    live[i >> 5] |= 1u << (i & 31);
+    count++;
+    return i;
+  }
+
+  void kill(int i) {
+    live[i >> 5] &= ~(1u << (i & 31));
+    next[i] = freeHead;
+    freeHead = i;
+    count--;
+  }
+
+  bool alive(int i) const { return live[i >> 5] >> (i & 31) & 1; }
+
+  // f(i) for each live slot. f may kill or add entities; slots killed ahead
+  // of the walk are skipped and slots added during it are not visited.
+  template <typename F>
+  void each(F f) {
+    for (int w = 0; w < WORDS; w++)
+      for (uint32_t m = live[w]; m; m &= live[w]) {
+        int i = w * 32 + __builtin_ctz(m);
+        m &= m - 1;
+        f(i);
+      }
+  }
+
+  // First live slot matching pred, or -1
+  template <typename P>
+  int find(P pred) const {
+    for (int w = 0; w < WORDS; w++)
+      for (uint32_t m = live[w]; m; m &= m - 1) {
+        int i = w * 32 + __builtin_ctz(m);
+        if (pred(i)) return i;
+      }
+    return -1;
+  }
+};
+
+#define SHOOT_SHOOTER 0x80   // enemy tag bit; the low bits are the enemy type
+
+template <int BULLETS, int ENEMIES, int EBULLETS>
+class ShootEngine {
+public:
+  EntityPool<BULLETS> bullets;
+  EntityPool<ENEMIES> enemies;
+  EntityPool<EBULLETS> enemyBullets;
+
+  fx playerY, bossY;
+  int score, lives, stage;
+  bool bossFight;
+  int bossDir, bossHealth, bossMaxHealth;
+
+  void reset(uint32_t now) {
+    bullets.clear();
+    enemies.clear();
+    enemyBullets.clear();
+    playerY = FX(14);
+    score = 0;
+    lives = 3;
+    stage = 1;
+    bossFight = false;
+    bossY = FX(SHOOT_TOP);
+    bossDir = 1;
+    bossHealth = bossMaxHealth = 10;
+    lastShoot = lastEnemy = lastEnemyShot = lastBossShot = lastStep = now;
+    playerDy = bossDy = 0;
+  }
+
+  int addBullet(fx px, fx py) { return bullets.add(px, py, SHOOT_BULLET_SPEED); }
+  int addEnemyShot(fx px, fx py) { return enemyBullets.add(px, py, -SHOOT_ESHOT_SPEED); }
+  int addEnemy(fx px, fx py, uint8_t tag) {
+    return enemies.add(px, py, -(SHOOT_ENEMY_SPEED + score * SHOOT_ENEMY_SCORE + (stage - 1) * SHOOT_ENEMY_STAGE), tag);
+  }
+
+  bool over() const { return lives <= 0; }
+
+  // One frame of play at time `now` (ms); things move by the time since the
+  // last one
+  void step(uint32_t now, bool up, bool down, bool fire) {
+    uint32_t dt = min<uint32_t>(now - lastStep, SHOOT_MAX_DT_MS);
+    lastStep = now;
+    fx y0 = playerY, d = fxTravel(SHOOT_PLAYER_SPEED, dt);
+    if (up) playerY = max<fx>(playerY - d, FX(SHOOT_TOP));
+    if (down) playerY = min<fx>(playerY + d, FX(SHOOT_PLAYER_MAX_Y));
+    playerDy = playerY - y0;
+    if (fire && now - lastShoot > SHOOT_FIRE_MS) {
+      addBullet(FX(SHOOT_PLAYER_X + 4), playerY + FX(1));
+      lastShoot = now;
+    }
+
+    if (!bossFight && now - lastEnemy > SHOOT_SPAWN_MS) {
+      spawnEnemy();
+      lastEnemy = now;
+    }
+    if (now - lastEnemyShot > SHOOT_VOLLEY_MS) {
+      enemies.each([&](int i) {
+        if (enemies.tag[i] & SHOOT_SHOOTER) addEnemyShot(enemies.x[i] - FX(1), enemies.y[i] + FX(1));
+      });
+      lastEnemyShot = now;
+    }
+    if (bossFight && now - lastBossShot > SHOOT_BOSS_SHOT_MS) {
+      addEnemyShot(FX(SHOOT_BOSS_X - 1), bossY + FX(6));
+      lastBossShot = now;
+    }
+
+    move(dt);
+    collide();
+
+    if (!bossFight && score >= SHOOT_BOSS_AT) {
+      bossFight = true;
+      enemies.clear();
+      bossMaxHealth = 10 + stage * 5;
+      bossHealth = bossMaxHealth;
+    }
+  }
+
+  void spawnEnemy() {
+    static const char types[] = { 'o', 'x', 's', 'b' };
+    uint8_t tag = types[gameRandom(0, 4)];
+    if (score >= 5 && gameRandom(0, 2)) tag |= SHOOT_SHOOTER;
+    addEnemy(FX(124), FX(gameRandom(SHOOT_TOP, 24)), tag);
+  }
+
+  // Everything that moves on its own, by dtMs worth
+  void move(uint32_t dtMs) {
+    PROF_SCOPE(PROF_MOVE);
+    bullets.each([&](int i) {
+      if ((bullets.x[i] += bullets.dx[i] = fxTravel(bullets.vx[i], dtMs)) >= FX(128)) bullets.kill(i);
+    });
+    enemies.each([&](int i) {
+      if ((enemies.x[i] += enemies.dx[i] = fxTravel(enemies.vx[i], dtMs)) <= 0) enemies.kill(i);
+    });
+    enemyBullets.each([&](int i) {
+      if ((enemyBullets.x[i] += enemyBullets.dx[i] = fxTravel(enemyBullets.vx[i], dtMs)) <= 0) enemyBullets.kill(i);
+    });
+
+    bossDy = 0;
+    if (bossFight) {
+      fx y0 = bossY;
+      bossY += bossDir * fxTravel(SHOOT_BOSS_SPEED, dtMs);
+      if (bossY <= FX(SHOOT_TOP) || bossY >= FX(18)) {
+        bossY = constrain(bossY, FX(SHOOT_TOP), FX(18));
+        bossDir = -bossDir;
+      }
+      bossDy = bossY - y0;
+    }
+  }
+
+  // Boxes as the old point-in-box tests had them, where each thing ended
+  // the step
+  FxBox bulletBox(int i) { return { bullets.x[i], bullets.y[i], FX(1), FX(1) }; }
+  FxBox enemyBox(int i) { return { enemies.x[i], enemies.y[i], FX(5), FX(5) }; }
+  FxBox shotBox(int i) { return { enemyBullets.x[i] - FX(1), enemyBullets.y[i] - FX(1), FX(3), FX(3) }; }
+
+  void collide() {
+    PROF_SCOPE(PROF_COLLIDE);
+    bullets.each([&](int i) {
+      FxBox b = bulletBox(i);
+      fx bdx = bullets.dx[i];
+      int e = enemies.find([&](int j) { return fxSweep(b, bdx, 0, enemyBox(j), enemies.dx[j], 0) >= 0; });
+      if (e >= 0) {
+        bullets.kill(i);
+        enemies.kill(e);
+        score++;
+        return;
+      }
+      int eb = enemyBullets.find([&](int j) { return fxSweep(b, bdx, 0, shotBox(j), enemyBullets.dx[j], 0) >= 0; });
+      if (eb >= 0) {
+        bullets.kill(i);
+        enemyBullets.kill(eb);
+        return;
+      }
+      FxBox boss = { FX(SHOOT_BOSS_X), bossY, FX(7), FX(13) };
+      if (bossFight && fxSweep(b, bdx, 0, boss, 0, bossDy) >= 0) {
+        bullets.kill(i);
+        bossHealth--;
+      }
+    });
+
+    // The player's box reaches back to the left edge
+    const FxBox player = { 0, playerY, FX(SHOOT_PLAYER_X + 4), FX(5) };
+    enemyBullets.each([&](int i) {
+      FxBox b = { enemyBullets.x[i], enemyBullets.y[i], FX(1), FX(1) };
+      if (fxSweep(b, enemyBullets.dx[i], 0, player, 0, playerDy) >= 0) {
+        enemyBullets.kill(i);
+        lives--;
+      }
+    });
+    enemies.each([&](int i) {
+      if (fxSweep(enemyBox(i), enemies.dx[i], 0, player, 0, playerDy) >= 0) {
+        enemies.kill(i);
+        lives--;
+      }
+    });
+
+    if (bossFight && bossHealth <= 0) {
+      bossFight = false;
+      stage++;
+      score = 0;
+    }
+  }
+
+  void drawHud(Adafruit_SSD1306 &d) {
+    d.drawLine(0, SHOOT_TOP - 1, 127, SHOOT_TOP - 1, SSD1306_WHITE);
+    uint8_t *fb = d.getBuffer();
+    for (int i = 0; i < lives; i++) blitSprite(fb, i * 6, 2, SPRITE_HEART);
+    d.setTextSize(1);
+    d.setFont();
+    d.setCursor(44, 1);
+    d.print("S:");
+    d.print(score);
+    d.setCursor(70, 1);
+    d.print("L:");
+    d.print(stage);
+    if (bossFight) {
+      d.drawRect(100, 1, 24, 5, SSD1306_WHITE);
+      d.fillRect(101, 2, bossHealth * 22 / bossMaxHealth, 3, SSD1306_WHITE);
+    }
+  }
+
+  // Whole frame into the framebuffer; the caller flushes
+  void draw(Adafruit_SSD1306 &d) {
+    d.clearDisplay();
+    drawHud(d);
+    uint8_t *fb = d.getBuffer();
+    blitSprite(fb, SHOOT_PLAYER_X, fxPx(playerY), SPRITE_PLANE);
+    bullets.each([&](int i) { blitSprite(fb, fxPx(bullets.x[i]), fxPx(bullets.y[i]), SPRITE_BULLET); });
+    enemies.each([&](int i) {
+      blitSprite(fb, fxPx(enemies.x[i]), fxPx(enemies.y[i]), enemySprite(enemies.tag[i] & ~SHOOT_SHOOTER));
+    });
+    enemyBullets.each([&](int i) { blitSprite(fb, fxPx(enemyBullets.x[i]), fxPx(enemyBullets.y[i]), SPRITE_ENEMY_SHOT); });
+    if (bossFight) blitSprite(fb, SHOOT_BOSS_X, fxPx(bossY), SPRITE_BOSS);
+  }
+
+private:
+  uint32_t lastShoot, lastEnemy, lastEnemyShot, lastBossShot, lastStep;
+  fx playerDy, bossDy;  // moved in the last step
+};
+
+#endif
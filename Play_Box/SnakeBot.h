@@ -0,0 +1,217 @@
+#ifndef SNAKE_BOT_H
+#define SNAKE_BOT_H
+
+#include "SnakeGame.h"
+
+// Autopilot for SnakeGame.h, and the attract mode that shows it off while
+// the menu sits idle.
+//
+// The planner floods the board breadth first with whole words of cells at
+// a time. The board is stored transposed, one uint32_t per column with bit y
+// for row y: GRID_HEIGHT is 15 (30 on the 1 px board), so a column always
+// fits one ESP32 word where a 53- or 106-cell row would not. One BFS layer
+// is then a shift up, a shift down and an OR of the two neighbouring
+// columns, masked by the free cells, and only the columns the frontier has
+// reached are touched.
+//
+// Each step the flood runs out from the food until it meets a cell next to
+// the head; that cell starts a shortest path. The move is taken only if the
+// tail can still be reached from where it leaves the head, which is what
+// keeps the snake from walling itself in. Otherwise the snake follows its
+// tail the long way round and waits for the food to come free.
+
+#define ATTRACT_IDLE_MS 10000   // menu idle time before the snake plays itself
+
+uint32_t botBody[GAME_WIDTH];    // the snake, head to tail
+uint32_t botFree[GAME_WIDTH];    // cells the flood may enter
+uint32_t botSeen[GAME_WIDTH];    // flooded so far
+uint32_t botFront[GAME_WIDTH];   // the last layer; zero outside botLo..botHi
+uint32_t botNext[GAME_WIDTH];
+int botLo, botHi;
+uint32_t botPlans = 0, botDetours = 0;
+
+inline bool botHas(const uint32_t *m, int x, int y) {
+  return x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT && (m[x] >> y & 1);
+}
+
+// botBody from the ring; once per plan, the floods patch copies of it
+void botBuild() {
+  memset(botBody, 0, GRID_WIDTH * sizeof(uint32_t));
+  for (int i = 0; i < snakeLength; i++) {
+    int c = snakeCell(i);
+    botBody[c % GRID_WIDTH] |= 1u << c / GRID_WIDTH;
+  }
+}
+
+// botFree with the snake in it, but for cell `open` (-1 for none)
+void botBoard(int open) {
+  uint32_t rows = (1u << GRID_HEIGHT) - 1;
+  for (int x = 0; x < GRID_WIDTH; x++) botFree[x] = rows & ~botBody[x];
+  if (open >= 0) botFree[open % GRID_WIDTH] |= 1u << open / GRID_WIDTH;
+}
+
+void botSeed(int x, int y) {
+  memset(botSeen, 0, GRID_WIDTH * sizeof(uint32_t));
+  memset(botFront, 0, GRID_WIDTH * sizeof(uint32_t));
+  botSeen[x] = botFront[x] = 1u << y;
+  botLo = botHi = x;
+}
+
+// Advances the flood one layer; false once nothing new was reached
+bool botLayer() {
+  int lo = max(botLo - 1, 0), hi = min(botHi + 1, GRID_WIDTH - 1);
+  int newLo = GRID_WIDTH, newHi = -1;
+  for (int x = lo; x <= hi; x++) {
+    uint32_t f = botFront[x];
+    uint32_t n = f << 1 | f >> 1;
+    if (x > 0) n |= botFront[x - 1];
+    if (x + 1 < GRID_WIDTH) n |= botFront[x + 1];
+    n &= botFree[x] & ~botSeen[x];
+    botNext[x] = n;
+    if (n) {
+      if (newLo > x) newLo = x;
+      newHi = x;
+    }
+  }
+  for (int x = lo; x <= hi; x++) {
+    botFront[x] = botNext[x];
+    botSeen[x] |= botNext[x];
+  }
+  botLo = newLo;
+  botHi = newHi;
+  return newHi >= 0;
+}
+
+static const int8_t botDirs[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+
+// Layers from (x, y) to the tail once the head has moved there, or -1 if
+// the tail is walled off. The flood stops at the tail; with `area` it runs
+// to the end instead and counts the cells it reached.
+int botTailDistance(int x, int y, int *area = nullptr) {
+  bool eating = x == foodX && y == foodY;
+  int tail = snakeCell(snakeLength - (eating ? 1 : 2));
+  int tx = tail % GRID_WIDTH, ty = tail / GRID_WIDTH;
+  botBoard(tail);
+  if (!eating) {
+    int old = snakeCell(snakeLength - 1);
+    botFree[old % GRID_WIDTH] |= 1u << old / GRID_WIDTH;
+  }
+  botFree[x] &= ~(1u << y);
+  botSeed(x, y);
+  int dist = -1;
+  for (int layer = 1; botLayer(); layer++) {
+    if (dist < 0 && (botFront[tx] >> ty & 1)) dist = layer;
+    if (dist >= 0 && !area) return dist;
+  }
+  if (!area) return dist;
+  *area = 0;
+  for (int i = 0; i < GRID_WIDTH; i++) *area += __builtin_popcount(botSeen[i]);
+  return dist;
+}
+
+// Sets dirX/dirY for the next moveSnake()
+void botSteer() {
+  botPlans++;
+  botBuild();
+  int head = snakeCell(0), oldTail = snakeCell(snakeLength - 1);
+  int hx = head % GRID_WIDTH, hy = head / GRID_WIDTH;
+
+  // Flood from the food until it touches a cell next to the head; keep the
+  // current heading on a tie so straight runs stay straight
+  botBoard(oldTail);
+  botSeed(foodX, foodY);
+  int toward = -1;
+  do {
+    for (int d = 0; d < 4; d++) {
+      int x = hx + botDirs[d][0], y = hy + botDirs[d][1];
+      if (botHas(botFront, x, y) && (toward < 0 || (botDirs[d][0] == dirX && botDirs[d][1] == dirY))) toward = d;
+    }
+  } while (toward < 0 && botLayer());
+
+  if (toward >= 0 && botTailDistance(hx + botDirs[toward][0], hy + botDirs[toward][1]) >= 0) {
+    dirX = botDirs[toward][0];
+    dirY = botDirs[toward][1];
+    return;
+  }
+
+  // No safe way to the food: the move that keeps the tail reachable by the
+  // longest route, else (only then flooding to the end) the one with the
+  // most room
+  botDetours++;
+  int moves[4], n = 0;
+  for (int d = 0; d < 4; d++) {
+    int x = hx + botDirs[d][0], y = hy + botDirs[d][1];
+    bool eating = x == foodX && y == foodY;
+    if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT &&
+        (!(botBody[x] >> y & 1) || (!eating && y * GRID_WIDTH + x == oldTail)))
+      moves[n++] = d;
+  }
+  int best = -1, bestDist = -1;
+  for (int i = 0; i < n; i++) {
+    int dist = botTailDistance(hx + botDirs[moves[i]][0], hy + botDirs[moves[i]][1]);
+    if (dist > bestDist) {
+      best = moves[i];
+      bestDist = dist;
+    }
+  }
+  for (int i = 0, bestArea = -1; best < 0 && i < n; i++) {
+    int area;
+    botTailDistance(hx + botDirs[moves[i]][0], hy + botDirs[moves[i]][1], &area);
+    if (area > bestArea) {
+      best = moves[i];
+      bestArea = area;
+    }
+  }
+  if (best >= 0) {
+    dirX = botDirs[best][0];
+    dirY = botDirs[best][1];
+  }
+}
+
+// --- Attract mode ---
+
+uint32_t attractUntil = 0;   // millis() at which the attract mode gives up; 0: never
+bool attractDone = false, attractPressed = false;
+
+void attractInit() {
+  snakeBlock = BLOCK_SIZE;
+  snakeTicks = 0;
+  attractDone = attractPressed = false;
+  clearButtonEvents();
+  startSnakeGame();
+}
+
+// Any press ends it (and does nothing else); so does attractUntil. A lost
+// or finished game starts over once "Game Over" has been up a while.
+void attractUpdate() {
+  ButtonEvent e;
+  while (nextButtonEvent(e))
+    if (e.type == BUTTON_PRESS) attractDone = attractPressed = true;
+  if (attractUntil && (int32_t)(millis() - attractUntil) >= 0) attractDone = true;
+
+  if (running) {
+    if (++snakeTicks * SNAKE_STEP_MS > snakeSpeed) {
+      botSteer();
+      moveSnake();
+      snakeDirty = true;
+      snakeTicks = 0;
+    }
+  } else if (!gameOverShown) {
+    snakeGameOverAnimation();
+  } else if (gameClock - snakeOverAt >= GAME_OVER_HOLD_MS) {
+    startSnakeGame();
+  }
+}
+
+bool attractFinished() { return attractDone; }
+
+const Game attractGame = { attractInit, attractUpdate, snakeRender, attractFinished, SNAKE_STEP_MS };
+
+// Plays until a button or `until`; true if a button ended it
+bool runAttract(uint32_t until) {
+  attractUntil = until;
+  runGame(attractGame);
+  return attractPressed;
+}
+
+#endif
@@ -1,10 +1,12 @@
 #ifndef SNAKE_GAME_H
 #define SNAKE_GAME_H
 
-#include <Adafruit_SSD1306.h>
+#include "PlayDisplay.h"
+#include "GameRuntime.h"
+#include "Buttons.h"
 #include <Fonts/FreeSans9pt7b.h>
 
-extern Adafruit_SSD1306 display;
+extern PlayDisplay display;
 
 #define BLOCK_SIZE 2
 #define BORDER 1
@@ -15,22 +17,41 @@ extern Adafruit_SSD1306 display;
 #define GAME_WIDTH    (128 - GAME_ORIGIN_X - BORDER)
 #define GAME_HEIGHT   (32 - 2 * BORDER)
 
-#define GRID_WIDTH  (GAME_WIDTH / BLOCK_SIZE)
-#define GRID_HEIGHT (GAME_HEIGHT / BLOCK_SIZE)
+// Block size is chosen per game (2 px normally, 1 px in fine mode); storage
+// is sized for the 1 px board.
+#define GRID_WIDTH  (GAME_WIDTH / snakeBlock)
+#define GRID_HEIGHT (GAME_HEIGHT / snakeBlock)
+#define SNAKE_MAX_CELLS (GAME_WIDTH * GAME_HEIGHT)
 
 #define BTN_DOWN 5
 #define BTN_UP   6
 #define BTN_RIGHT 7
 #define BTN_LEFT  8
 
-int snakeX[100], snakeY[100], snakeLength;
+#define SNAKE_STEP_MS 10
+
+int snakeBlock = BLOCK_SIZE;
+
+// Body is a ring of cell indices (y * GRID_WIDTH + x), head at snakeHead.
+// snakeOcc is a bit per cell; freeCells/freePos is an unordered set of the
+// cells not under the snake, so food placement is one random pick.
+uint16_t snakeBody[SNAKE_MAX_CELLS];
+int snakeHead, snakeLength;
+uint32_t snakeOcc[(SNAKE_MAX_CELLS + 31) / 32];
+uint16_t freeCells[SNAKE_MAX_CELLS], freePos[SNAKE_MAX_CELLS];
+int freeCount;
 int foodX, foodY;
 int dirX = 1, dirY = 0;
-unsigned long lastMove = 0;
 int snakeSpeed = 120;
 bool running = true, gameOverShown = false, paused = false;
-unsigned long btnHoldStart = 0;
-bool btnHeld = false;
+int snakeTicks = 0, snakeExitTicks = 0;
+bool snakeDirty = false, snakeExit = false;
+
+// Retained rendering: what changed since the last frame was drawn
+int snakeMovedTail = -1;      // cell vacated by the last step, -1 if none
+int snakeMoves = 0;           // steps since the last render
+bool snakeGrew = false, snakeFullRedraw = true, pauseShown = false;
+uint32_t snakeOverAt = 0;
 
 void drawSnakeBorders() {
   display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
@@ -44,100 +65,154 @@ void drawSnakeScore() {
   display.setCursor(6, 18); display.print(snakeLength - 3);
 }
 
-void drawSnakeBlock(int gx, int gy) {
-  int px = GAME_ORIGIN_X + gx * BLOCK_SIZE;
-  int py = GAME_ORIGIN_Y + gy * BLOCK_SIZE;
-  display.fillRect(px, py, BLOCK_SIZE, BLOCK_SIZE, SSD1306_WHITE);
+// i = 0 is the head
+int snakeCell(int i) {
+  int at = snakeHead - i;
+  return snakeBody[at < 0 ? at + SNAKE_MAX_CELLS : at];
+}
+
+bool cellTaken(int cell) { return snakeOcc[cell >> 5] & (1u << (cell & 31)); }
+
+void takeCell(int cell) {
+  snakeOcc[cell >> 5] |= 1u << (cell & 31);
+  int last = freeCells[--freeCount];
+  freeCells[freePos[cell]] = last;
+  freePos[last] = freePos[cell];
+}
+
+void releaseCell(int cell) {
+  snakeOcc[cell >> 5] &= ~(1u << (cell & 31));
+  freePos[cell] = freeCount;
+  freeCells[freeCount++] = cell;
+}
+
+void drawSnakeBlock(int gx, int gy, uint16_t color = SSD1306_WHITE) {
+  int px = GAME_ORIGIN_X + gx * snakeBlock;
+  int py = GAME_ORIGIN_Y + gy * snakeBlock;
+  display.fillRect(px, py, snakeBlock, snakeBlock, color);
 }
 
 void drawSnakeGame() {
   display.clearDisplay();
   drawSnakeBorders();
   drawSnakeScore();
-  for (int i = 0; i < snakeLength; i++) drawSnakeBlock(snakeX[i], snakeY[i]);
+  for (int i = 0; i < snakeLength; i++) {
+    int c = snakeCell(i);
+    drawSnakeBlock(c % GRID_WIDTH, c / GRID_WIDTH);
+  }
   drawSnakeBlock(foodX, foodY);
   display.display();
 }
 
-void generateFood() {
-  while (true) {
-    foodX = random(0, GRID_WIDTH);
-    foodY = random(0, GRID_HEIGHT);
-    bool clash = false;
-    for (int i = 0; i < snakeLength; i++) {
-      if (snakeX[i] == foodX && snakeY[i] == foodY) {
-        clash = true;
-        break;
-      }
+// One step only touches the head, the vacated tail, and on growth the food
+// and score, so that is all that gets drawn and flushed.
+void drawSnakeStep() {
+  if (snakeFullRedraw || snakeMoves > 1) {
+    drawSnakeGame();
+  } else {
+    if (snakeMovedTail >= 0)
+      drawSnakeBlock(snakeMovedTail % GRID_WIDTH, snakeMovedTail / GRID_WIDTH, SSD1306_BLACK);
+    int head = snakeCell(0);
+    drawSnakeBlock(head % GRID_WIDTH, head / GRID_WIDTH);
+    if (snakeGrew) {
+      drawSnakeBlock(foodX, foodY);
+      display.fillRect(BORDER, 18, SCORE_BOX_WIDTH - 2 * BORDER, 8, SSD1306_BLACK);
+      drawSnakeScore();
     }
-    if (!clash) break;
+    display.display();
   }
+  snakeFullRedraw = false;
+  snakeGrew = false;
+  snakeMovedTail = -1;
+  snakeMoves = 0;
+}
+
+// Returns false when the snake fills the board
+bool generateFood() {
+  if (!freeCount) return false;
+  int c = freeCells[gameRandom(0, freeCount)];
+  foodX = c % GRID_WIDTH;
+  foodY = c / GRID_WIDTH;
+  return true;
 }
 
 void startSnakeGame() {
+  int cells = GRID_WIDTH * GRID_HEIGHT;
+  memset(snakeOcc, 0, sizeof(snakeOcc));
+  for (int c = 0; c < cells; c++) freeCells[c] = freePos[c] = c;
+  freeCount = cells;
+
   snakeLength = 3;
+  snakeHead = snakeLength - 1;
   dirX = 1; dirY = 0;
   for (int i = 0; i < snakeLength; i++) {
-    snakeX[i] = 5 - i;
-    snakeY[i] = 4;
+    int c = 4 * GRID_WIDTH + 5 - i;
+    snakeBody[snakeHead - i] = c;
+    takeCell(c);
   }
   generateFood();
   running = true;
   gameOverShown = false;
   paused = false;
+  pauseShown = false;
+  snakeMovedTail = -1;
+  snakeMoves = 0;
+  snakeGrew = false;
   drawSnakeGame();
+  snakeFullRedraw = false;
 }
 
 void snakeGameOver() {
   running = false;
 }
 
-void handleSnakeInput() {
-  if (!digitalRead(BTN_UP) && dirY == 0)    { dirX = 0; dirY = -1; }
-  if (!digitalRead(BTN_DOWN) && dirY == 0)  { dirX = 0; dirY = 1;  }
-  if (!digitalRead(BTN_LEFT) && dirX == 0)  { dirX = -1; dirY = 0; }
-  if (!digitalRead(BTN_RIGHT) && dirX == 0) { dirX = 1; dirY = 0;  }
+void handleSnakeInput(const ButtonEvent &e) {
+  if (e.type != BUTTON_PRESS) return;
+  if (e.pin == BTN_UP && dirY == 0)    { dirX = 0; dirY = -1; }
+  if (e.pin == BTN_DOWN && dirY == 0)  { dirX = 0; dirY = 1;  }
+  if (e.pin == BTN_LEFT && dirX == 0)  { dirX = -1; dirY = 0; }
+  if (e.pin == BTN_RIGHT && dirX == 0) { dirX = 1; dirY = 0;  }
 }
 
 void moveSnake() {
-  for (int i = snakeLength - 1; i > 0; i--) {
-    snakeX[i] = snakeX[i - 1];
-    snakeY[i] = snakeY[i - 1];
+  PROF_SCOPE(PROF_MOVE);
+  int head = snakeCell(0);
+  int x = head % GRID_WIDTH + dirX;
+  int y = head / GRID_WIDTH + dirY;
+
+  if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) {
+    snakeGameOver();
+    return;
   }
 
-  snakeX[0] += dirX;
-  snakeY[0] += dirY;
+  int next = y * GRID_WIDTH + x;
+  bool eating = x == foodX && y == foodY;
+
+  // The tail moves away this step, so the head may enter its cell
+  if (!eating) {
+    snakeMovedTail = snakeCell(snakeLength - 1);
+    releaseCell(snakeMovedTail);
+  }
 
-  if (snakeX[0] < 0 || snakeX[0] >= GRID_WIDTH || snakeY[0] < 0 || snakeY[0] >= GRID_HEIGHT) {
+  if (cellTaken(next)) {
     snakeGameOver();
     return;
   }
 
-  for (int i = 1; i < snakeLength; i++) {
-    if (snakeX[0] == snakeX[i] && snakeY[0] == snakeY[i]) {
-      snakeGameOver();
-      return;
-    }
-  }
+  takeCell(next);
+  if (++snakeHead == SNAKE_MAX_CELLS) snakeHead = 0;
+  snakeBody[snakeHead] = next;
 
-  if (snakeX[0] == foodX && snakeY[0] == foodY && snakeLength < 100) {
+  snakeMoves++;
+  if (eating) {
+    snakeGrew = true;
     snakeLength++;
-    generateFood();
+    if (!generateFood()) snakeGameOver();  // board full
   }
 }
 
-void checkPauseSnake() {
-  if (!digitalRead(BTN_DOWN)) {
-    if (!btnHeld) {
-      btnHoldStart = millis();
-      btnHeld = true;
-    } else if (millis() - btnHoldStart > 1000) {
-      paused = !paused;
-      btnHeld = false;
-    }
-  } else {
-    btnHeld = false;
-  }
+void checkPauseSnake(const ButtonEvent &e) {
+  if (e.type == BUTTON_HOLD && e.pin == BTN_DOWN) paused = !paused;
 }
 
 void snakeGameOverAnimation() {
@@ -156,45 +231,85 @@ void snakeGameOverAnimation() {
   display.print("Restart it.. >");
 
   display.display();
-  delay(1500);
+  snakeOverAt = gameClock;
   gameOverShown = true;
 }
 
-void runSnakeGame() {
+void snakeInit() {
+  snakeTicks = 0;
+  snakeExitTicks = 0;
+  snakeExit = false;
+  clearButtonEvents();
   startSnakeGame();
+}
+
+void snakeUpdate() {
+  ButtonEvent e;
+  while (nextButtonEvent(e)) {
+    checkPauseSnake(e);
+    if (running && !paused) handleSnakeInput(e);
+    else if (!running && gameClock - snakeOverAt >= GAME_OVER_HOLD_MS &&
+             e.type == BUTTON_PRESS && e.pin == BTN_DOWN)
+      snakeExit = true; // Exit to menu
+  }
 
-  while (true) {
-    checkPauseSnake();
-
-    if (running && !paused) {
-      handleSnakeInput();
-      if (millis() - lastMove > snakeSpeed) {
-        moveSnake();
-        drawSnakeGame();
-        lastMove = millis();
-      }
-    } else if (!running) {
-      if (!gameOverShown) snakeGameOverAnimation();
-      if (!digitalRead(BTN_DOWN)) {
-        delay(300);
-        return; // Exit to menu
-      }
-    } else {
-      display.setTextSize(1);
-      display.setCursor(45, 10);
-      display.print("Paused...");
-      display.display();
-      delay(100);
+  if (running && !paused) {
+    if (++snakeTicks * SNAKE_STEP_MS > snakeSpeed) {
+      moveSnake();
+      snakeDirty = true;
+      snakeTicks = 0;
     }
+  } else if (!running) {
+    if (!gameOverShown) snakeGameOverAnimation();
+  }
+
+  if (buttonDown(BTN_UP) && buttonDown(BTN_RIGHT)) {
+    if (++snakeExitTicks * SNAKE_STEP_MS > 1000) snakeExit = true; // Exit game
+  } else {
+    snakeExitTicks = 0;
+  }
+}
 
-    if (!digitalRead(BTN_UP) && !digitalRead(BTN_RIGHT)) {
-      unsigned long holdStart = millis();
-      while (!digitalRead(BTN_UP) && !digitalRead(BTN_RIGHT)) {
-        if (millis() - holdStart > 1000) return; // Exit game
-        delay(10);
-      }
+void snakeRender() {
+  if (running && paused) {
+    if (pauseShown) return;
+    display.setTextSize(1);
+    display.setCursor(45, 10);
+    display.print("Paused...");
+    display.display();
+    pauseShown = true;
+  } else if (running) {
+    if (pauseShown) {
+      snakeFullRedraw = true;  // wipe the overlay
+      pauseShown = false;
     }
+    if (snakeDirty || snakeFullRedraw) drawSnakeStep();
+    snakeDirty = false;
   }
 }
 
+bool snakeFinished() { return snakeExit; }
+
+void snakeFineInit() {
+  snakeBlock = 1;
+  snakeInit();
+}
+
+void snakeNormalInit() {
+  snakeBlock = BLOCK_SIZE;
+  snakeInit();
+}
+
+const Game snakeGame = { snakeNormalInit, snakeUpdate, snakeRender, snakeFinished, SNAKE_STEP_MS };
+const Game snakeFineGame = { snakeFineInit, snakeUpdate, snakeRender, snakeFinished, SNAKE_STEP_MS };
+
+void runSnakeGame() {
+  runGame(snakeGame);
+}
+
+// 1 px blocks: a 106x30 board
+void runSnakeFineGame() {
+  runGame(snakeFineGame);
+}
+
 #endif
@@ -0,0 +1,205 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Sprite atlas. Art is written as rows of '#'/'.' and packed at compile time
+// into SSD1306 column format: one word per column, bit 0 = top row. The
+// blitter shifts each column to the target row and writes it into at most
+// three framebuffer pages, so a sprite costs a few byte operations per column.
+// Each sprite reproduces what the GFX primitives it replaces used to draw.
+
+#define SPRITE_MAX_W 8
+#define SPRITE_MAX_H 16
+#define SPRITE_FB_WIDTH 128
+#define SPRITE_FB_PAGES 4
+
+struct Sprite {
+  uint8_t w, h;
+  uint16_t cols[SPRITE_MAX_W];
+};
+
+template <size_t H, size_t N>
+constexpr Sprite packSprite(const char (&rows)[H][N]) {
+  static_assert(N - 1 <= SPRITE_MAX_W && H <= SPRITE_MAX_H, "sprite too large");
+  Sprite s = { (uint8_t)(N - 1), (uint8_t)H, {} };
+  for (size_t y = 0; y < H; y++)
+    for (size_t x = 0; x + 1 < N; x++)
+      if (rows[y][x] == '#') s.cols[x] |= 1u << y;
+  return s;
+}
+
+// drawPlane(): pixel, 3 px vertical line, 2 px nose
+constexpr char PLANE_ART[][5] = {
+  ".#..",
+  "####",
+  ".#..",
+};
+
+// drawCircle(x + 2, y + 2, 2)
+constexpr char ENEMY_O_ART[][6] = {
+  ".###.",
+  "#...#",
+  "#...#",
+  "#...#",
+  ".###.",
+};
+
+// Two diagonals across 4x4
+constexpr char ENEMY_X_ART[][5] = {
+  "#..#",
+  ".##.",
+  ".##.",
+  "#..#",
+};
+
+// fillTriangle(x, y + 4, x + 2, y, x + 4, y + 4)
+constexpr char ENEMY_S_ART[][6] = {
+  "..#..",
+  "..#..",
+  ".###.",
+  ".###.",
+  "#####",
+};
+
+// drawRect(x, y, 4, 4)
+constexpr char ENEMY_B_ART[][5] = {
+  "####",
+  "#..#",
+  "#..#",
+  "####",
+};
+
+// fillRect(x, y, 4, 4)
+constexpr char BLOCK4_ART[][5] = {
+  "####",
+  "####",
+  "####",
+  "####",
+};
+
+// drawRect(100, y, 6, 12) with both diagonals to (106, y + 12)
+constexpr char BOSS_ART[][8] = {
+  "#######",
+  "#....##",
+  "##...#.",
+  "##...#.",
+  "#.#.##.",
+  "#.#.##.",
+  "#..#.#.",
+  "#..#.#.",
+  "#.#.##.",
+  "#.#.##.",
+  "##...#.",
+  "######.",
+  "#.....#",
+};
+
+// fillCircle(x + 2, y + 2, 2)
+constexpr char HEART_ART[][6] = {
+  ".###.",
+  "#####",
+  "#####",
+  "#####",
+  ".###.",
+};
+
+// Play_Box player ship: fillRect(x, y, 3, 5)
+constexpr char SHIP_ART[][4] = {
+  "###",
+  "###",
+  "###",
+  "###",
+  "###",
+};
+
+constexpr char BULLET_ART[][2] = { "#" };
+
+// print("-") in the built-in font: a 5 px bar on the fourth row of the cell
+constexpr char ENEMY_SHOT_ART[][6] = {
+  ".....",
+  ".....",
+  ".....",
+  "#####",
+};
+
+// Bullet Hell enemy shot: drawFastHLine(x, y, 2)
+constexpr char SHOT2_ART[][3] = { "##" };
+
+// Menu icons
+constexpr char ICON_SNAKE_ART[][7] = {
+  "####..",
+  "...#..",
+  ".###..",
+  ".#....",
+  ".####.",
+  "....##",
+};
+
+constexpr char ICON_JUMP_ART[][7] = {
+  ".##...",
+  ".##...",
+  "......",
+  "....#.",
+  "....#.",
+  "######",
+};
+
+constexpr char ICON_BACK_ART[][7] = {
+  "..#...",
+  ".#....",
+  "######",
+  ".#....",
+  "..#...",
+};
+
+constexpr Sprite SPRITE_PLANE = packSprite(PLANE_ART);
+constexpr Sprite SPRITE_ENEMY_O = packSprite(ENEMY_O_ART);
+constexpr Sprite SPRITE_ENEMY_X = packSprite(ENEMY_X_ART);
+constexpr Sprite SPRITE_ENEMY_S = packSprite(ENEMY_S_ART);
+constexpr Sprite SPRITE_ENEMY_B = packSprite(ENEMY_B_ART);
+constexpr Sprite SPRITE_BLOCK4 = packSprite(BLOCK4_ART);
+constexpr Sprite SPRITE_BOSS = packSprite(BOSS_ART);
+constexpr Sprite SPRITE_HEART = packSprite(HEART_ART);
+constexpr Sprite SPRITE_SHIP = packSprite(SHIP_ART);
+constexpr Sprite SPRITE_BULLET = packSprite(BULLET_ART);
+constexpr Sprite SPRITE_ENEMY_SHOT = packSprite(ENEMY_SHOT_ART);
+constexpr Sprite SPRITE_SHOT2 = packSprite(SHOT2_ART);
+constexpr Sprite ICON_SNAKE = packSprite(ICON_SNAKE_ART);
+constexpr Sprite ICON_JUMP = packSprite(ICON_JUMP_ART);
+constexpr Sprite ICON_BACK = packSprite(ICON_BACK_ART);
+
+static_assert(SPRITE_PLANE.cols[1] == 0x7, "plane art packed wrong");
+
+constexpr const Sprite &enemySprite(char type) {
+  return type == 'o' ? SPRITE_ENEMY_O
+       : type == 'x' ? SPRITE_ENEMY_X
+       : type == 's' ? SPRITE_ENEMY_S
+       : type == 'b' ? SPRITE_ENEMY_B
+       : SPRITE_BLOCK4;
+}
+
+enum BlitMode : uint8_t { BLIT_OR, BLIT_CLEAR, BLIT_XOR };
+
+inline void blitSprite(uint8_t *fb, int x, int y, const Sprite &s, BlitMode mode = BLIT_OR) {
+  if (y <= -SPRITE_MAX_H || y >= SPRITE_FB_PAGES * 8) return;
+  int page = y >> 3;   // floors for negative y
+  int shift = y & 7;
+  for (int c = 0; c < s.w; c++) {
+    int sx = x + c;
+    if (sx < 0 || sx >= SPRITE_FB_WIDTH) continue;
+    uint32_t m = (uint32_t)s.cols[c] << shift;
+    for (int k = 0; k < 3; k++, m >>= 8) {
+      uint8_t bits = m & 0xFF;
+      int p = page + k;
+      if (!bits || p < 0 || p >= SPRITE_FB_PAGES) continue;
+      uint8_t &dst = fb[p * SPRITE_FB_WIDTH + sx];
+      if (mode == BLIT_OR) dst |= bits;
+      else if (mode == BLIT_CLEAR) dst &= ~bits;
+      else dst ^= bits;
+    }
+  }
+}
+
+#endif
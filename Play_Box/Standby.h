@@ -0,0 +1,69 @@
+#ifndef STANDBY_H
+#define STANDBY_H
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include "Buttons.h"
+
+// Standby: the panel is off and nothing is drawn or polled. The CPU stays in
+// light sleep until a button pulls its pin low, waking once a minute only to
+// roll the duty-cycle counter over.
+
+#define STANDBY_WINDOW_MS 60000
+
+struct StandbyStats {
+  uint32_t windowStart;    // ms, start of the current minute
+  uint32_t activeUs;       // awake time so far this minute
+  uint32_t wakes;
+  uint32_t lastActiveUs;   // the last full minute
+  uint32_t lastWakes;
+  uint32_t minutes;        // full minutes spent in standby
+};
+
+StandbyStats standbyStats;
+uint32_t standbyAwakeAt = 0;   // micros() at the last wake
+
+void standbyBegin() {
+  standbyStats.windowStart = millis();
+  standbyStats.activeUs = 0;
+  standbyStats.wakes = 0;
+  standbyAwakeAt = micros();
+}
+
+// Sleeps until a button goes down or the minute ends; true if a button woke us
+bool standbySleep() {
+  StandbyStats &s = standbyStats;
+  s.activeUs += micros() - standbyAwakeAt;
+
+  uint32_t inWindow = millis() - s.windowStart;
+  if (inWindow >= STANDBY_WINDOW_MS) {
+    s.lastActiveUs = s.activeUs;
+    s.lastWakes = s.wakes;
+    s.minutes++;
+    Serial.printf("standby: %lu us active, %lu wakes in the last minute\n",
+                  (unsigned long)s.activeUs, (unsigned long)s.wakes);
+    s.windowStart += (inWindow / STANDBY_WINDOW_MS) * STANDBY_WINDOW_MS;
+    s.activeUs = 0;
+    s.wakes = 0;
+    inWindow = millis() - s.windowStart;
+  }
+  Serial.flush();
+
+  for (int i = 0; i < BUTTON_COUNT; i++)
+    gpio_wakeup_enable((gpio_num_t)(BUTTON_FIRST_PIN + i), GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)(STANDBY_WINDOW_MS - inWindow) * 1000ULL);
+  esp_light_sleep_start();
+
+  // Level wake-up replaced the pins' edge interrupts; put them back
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    gpio_wakeup_disable((gpio_num_t)(BUTTON_FIRST_PIN + i));
+    gpio_set_intr_type((gpio_num_t)(BUTTON_FIRST_PIN + i), GPIO_INTR_ANYEDGE);
+  }
+  standbyAwakeAt = micros();
+  s.wakes++;
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+}
+
+#endif
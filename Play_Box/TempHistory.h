@@ -0,0 +1,171 @@
+#ifndef TEMP_HISTORY_H
+#define TEMP_HISTORY_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Temperature history. Readings (one a second while awake, one a minute in
+// standby) average into one sample a minute, kept in a RAM ring of the last
+// TEMP_RAW_LEN minutes. Every 15 samples close a bucket of the 24 h tier and
+// every 8 of those a bucket of the 7 d tier; buckets keep min, max and mean.
+//
+// Values are tenths of a degree. A bucket is 3 bytes: its mean as an int8
+// delta from the previous bucket's, and min and max as distances below and
+// above the mean. Deltas are taken from the decoded previous mean, so a step
+// too big for an int8 is caught up by the next bucket instead of drifting.
+//
+// The whole history is one Preferences blob, written every TEMP_SAVE_MIN
+// samples rather than on each one.
+
+#define TEMP_RAW_LEN       128    // samples (minutes), one screen width
+#define TEMP_DAY_LEN       96     // 15 min buckets
+#define TEMP_DAY_SAMPLES   15
+#define TEMP_WEEK_LEN      84     // 2 h buckets
+#define TEMP_WEEK_BUCKETS  8      // day buckets per week bucket
+#define TEMP_SAMPLE_MS     60000UL
+#define TEMP_SAVE_MIN      20
+#define TEMP_NONE          INT16_MIN
+#define TEMP_MAGIC         0x504D4554UL  // "TEMP"
+
+struct TempBucket {
+  int16_t lo, hi, avg;
+};
+
+// Running min/max/mean
+struct TempAcc {
+  int16_t lo, hi;
+  int32_t sum;
+  uint16_t n;
+
+  void clear() { n = 0; sum = 0; }
+
+  void add(int l, int h, int v) {
+    if (!n || l < lo) lo = l;
+    if (!n || h > hi) hi = h;
+    sum += v;
+    n++;
+  }
+
+  TempBucket get() const {
+    int32_t half = sum < 0 ? -(int32_t)n / 2 : n / 2;
+    return { lo, hi, (int16_t)((sum + half) / (int32_t)n) };
+  }
+};
+
+// Ring of N delta-encoded buckets; bucket k (counting every push) lives in
+// slot k % N
+template <int N>
+struct TempTier {
+  uint32_t total;     // buckets ever pushed
+  uint16_t count;     // buckets held, at most N
+  int16_t first;      // decoded mean of the oldest held bucket
+  int16_t last;       // and of the newest
+  int8_t delta[N];    // mean minus the previous bucket's; unused for the oldest
+  uint8_t below[N], above[N];
+
+  void clear() {
+    total = 0;
+    count = 0;
+  }
+
+  void push(const TempBucket &b) {
+    int slot = total % N;
+    int d = count ? constrain(b.avg - last, -128, 127) : 0;
+    int avg = count ? last + d : b.avg;
+    if (count == N) first += delta[(slot + 1) % N];  // the oldest drops out
+    else if (!count++) first = avg;
+    delta[slot] = d;
+    below[slot] = constrain(avg - b.lo, 0, 255);
+    above[slot] = constrain(b.hi - avg, 0, 255);
+    last = avg;
+    total++;
+  }
+
+  TempBucket decode(int slot, int avg) const {
+    return { (int16_t)(avg - below[slot]), (int16_t)(avg + above[slot]), (int16_t)avg };
+  }
+
+  TempBucket newest() const {
+    return decode((total - 1) % N, last);
+  }
+
+  // f(k, bucket) oldest first, k counting every push
+  template <typename F>
+  void each(F f) const {
+    int avg = first;
+    for (uint32_t k = total - count; k < total; k++) {
+      int slot = k % N;
+      if (k != total - count) avg += delta[slot];
+      f(k, decode(slot, avg));
+    }
+  }
+};
+
+// The saved blob
+struct TempHistory {
+  uint32_t magic;
+  uint32_t rawTotal;
+  int16_t raw[TEMP_RAW_LEN];   // sample k in slot k % TEMP_RAW_LEN
+  TempTier<TEMP_DAY_LEN> day;
+  TempTier<TEMP_WEEK_LEN> week;
+  TempAcc dayAcc, weekAcc;     // the buckets being filled
+};
+
+TempHistory tempHist;
+TempAcc tempMinute;            // readings towards the next sample
+uint32_t tempMinuteStart;
+int16_t tempNow = TEMP_NONE;   // latest reading
+uint8_t tempUnsaved = 0;       // samples since the last save
+
+void tempClear() {
+  memset(&tempHist, 0, sizeof(tempHist));
+  tempHist.magic = TEMP_MAGIC;
+}
+
+void tempAddSample(int v) {
+  TempHistory &h = tempHist;
+  h.raw[h.rawTotal++ % TEMP_RAW_LEN] = v;
+  h.dayAcc.add(v, v, v);
+  if (h.dayAcc.n == TEMP_DAY_SAMPLES) {
+    TempBucket b = h.dayAcc.get();
+    h.day.push(b);
+    h.dayAcc.clear();
+    h.weekAcc.add(b.lo, b.hi, b.avg);
+    if (h.weekAcc.n == TEMP_WEEK_BUCKETS) {
+      h.week.push(h.weekAcc.get());
+      h.weekAcc.clear();
+    }
+  }
+  if (tempUnsaved < 255) tempUnsaved++;
+}
+
+// A reading in degrees C at nowMs. A minute's readings become one sample;
+// the 1 s slack lets the standby wake, which comes once a minute but not to
+// the millisecond, close a sample every time.
+void tempReading(float c, uint32_t nowMs) {
+  int v = lroundf(c * 10);
+  tempNow = v;
+  if (tempMinute.n && nowMs - tempMinuteStart >= TEMP_SAMPLE_MS - 1000) {
+    tempAddSample(tempMinute.get().avg);
+    tempMinute.clear();
+  }
+  if (!tempMinute.n) tempMinuteStart = nowMs;
+  tempMinute.add(v, v, v);
+}
+
+inline bool tempSaveDue() { return tempUnsaved >= TEMP_SAVE_MIN; }
+
+void tempSave(Preferences &prefs) {
+  prefs.putBytes("hist", &tempHist, sizeof(tempHist));
+  tempUnsaved = 0;
+}
+
+// Starts empty if nothing (or something of another layout) was saved
+void tempLoad(Preferences &prefs) {
+  if (prefs.getBytesLength("hist") == sizeof(tempHist) && prefs.getBytes("hist", &tempHist, sizeof(tempHist)) &&
+      tempHist.magic == TEMP_MAGIC)
+    return;
+  tempClear();
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef TREND_SCREEN_H
+#define TREND_SCREEN_H
+
+#include <Adafruit_SSD1306.h>
+#include "TempHistory.h"
+
+// Temperature trend: a header line and a sparkline of one history range
+// below it. The sparkline sweeps like a chart recorder: bucket k sits in a
+// fixed column, k % range length, with a blank column after the newest. A
+// new sample therefore repaints one column and blanks the next; only a
+// value outside the current scale or a range change redraws the whole
+// graph. Nothing here calls display(): the caller flushes.
+
+#define TREND_TOP     9     // graph rows TREND_TOP..31
+#define TREND_BOTTOM  31
+
+enum TrendRange : uint8_t { TREND_2H, TREND_24H, TREND_7D, TREND_RANGES };
+
+TrendRange trendRange = TREND_2H;
+bool trendValid = false;
+uint32_t trendShown;        // buckets in the range when it was last drawn
+int16_t trendLo, trendHi;   // scale, tenths of a degree
+char trendHeadShown[24];
+
+void trendInvalidate() { trendValid = false; }
+
+void trendNextRange(int dir) {
+  trendRange = (TrendRange)((trendRange + dir + TREND_RANGES) % TREND_RANGES);
+  trendValid = false;
+}
+
+// Buckets of the current range, oldest first: f(k, bucket). Raw samples are
+// buckets with lo == hi == avg.
+template <typename F>
+void trendEach(F f) {
+  const TempHistory &h = tempHist;
+  if (trendRange == TREND_24H) h.day.each(f);
+  else if (trendRange == TREND_7D) h.week.each(f);
+  else
+    for (uint32_t k = h.rawTotal > TEMP_RAW_LEN ? h.rawTotal - TEMP_RAW_LEN : 0; k < h.rawTotal; k++) {
+      int16_t v = h.raw[k % TEMP_RAW_LEN];
+      f(k, TempBucket{ v, v, v });
+    }
+}
+
+uint32_t trendTotal() {
+  if (trendRange == TREND_24H) return tempHist.day.total;
+  if (trendRange == TREND_7D) return tempHist.week.total;
+  return tempHist.rawTotal;
+}
+
+int trendLen() {
+  static const int len[] = { TEMP_RAW_LEN, TEMP_DAY_LEN, TEMP_WEEK_LEN };
+  return len[trendRange];
+}
+
+inline int trendX(uint32_t k) { return 128 - trendLen() + k % trendLen(); }
+
+inline int trendY(int v) {
+  return TREND_BOTTOM - (v - trendLo) * (TREND_BOTTOM - TREND_TOP) / (trendHi - trendLo);
+}
+
+// Column for bucket b; prev is the previous bucket's mean (TEMP_NONE if
+// none), joined to this one so raw samples read as a line
+void trendColumn(Adafruit_SSD1306 &d, uint32_t k, const TempBucket &b, int prev) {
+  int x = trendX(k);
+  d.drawFastVLine(x, TREND_TOP, TREND_BOTTOM - TREND_TOP + 1, SSD1306_BLACK);
+  int lo = b.lo, hi = b.hi;
+  if (prev != TEMP_NONE) {
+    lo = min(lo, (prev + b.avg) / 2);
+    hi = max(hi, (prev + b.avg) / 2);
+  }
+  d.drawFastVLine(x, trendY(hi), trendY(lo) - trendY(hi) + 1, SSD1306_WHITE);
+}
+
+void trendGap(Adafruit_SSD1306 &d, uint32_t k) {
+  d.drawFastVLine(trendX(k), TREND_TOP, TREND_BOTTOM - TREND_TOP + 1, SSD1306_BLACK);
+}
+
+// Scale from the data on screen, with a little margin and at least 2 C
+void trendScale() {
+  int lo = INT16_MAX, hi = INT16_MIN;
+  trendEach([&](uint32_t, const TempBucket &b) {
+    lo = min(lo, (int)b.lo);
+    hi = max(hi, (int)b.hi);
+  });
+  if (lo > hi) lo = hi = tempNow == TEMP_NONE ? 200 : tempNow;
+  lo -= 5;
+  hi += 5;
+  if (hi - lo < 20) {
+    int mid = (lo + hi) / 2;
+    lo = mid - 10;
+    hi = mid + 10;
+  }
+  trendLo = lo;
+  trendHi = hi;
+}
+
+void trendHeader(Adafruit_SSD1306 &d) {
+  static const char *const names[] = { "2h", "24h", "7d" };
+  char now[8] = "--.-";
+  if (tempNow != TEMP_NONE) snprintf(now, sizeof(now), "%.1f", tempNow / 10.0f);
+  char head[sizeof(trendHeadShown)];
+  snprintf(head, sizeof(head), "%-3s %sC %.1f-%.1f", names[trendRange], now, trendLo / 10.0f, trendHi / 10.0f);
+  if (trendValid && !strcmp(head, trendHeadShown)) return;
+  d.fillRect(0, 0, d.width(), 8, SSD1306_BLACK);
+  d.setFont();
+  d.setTextSize(1);
+  d.setTextColor(SSD1306_WHITE);
+  d.setCursor(0, 0);
+  d.print(head);
+  strcpy(trendHeadShown, head);
+}
+
+void trendDraw(Adafruit_SSD1306 &d) {
+  uint32_t total = trendTotal();
+  if (trendValid && total == trendShown + 1) {
+    // One new bucket: its column and the gap after it, unless it is off the
+    // scale. The tiers only decode from the oldest, which is cheap next to
+    // drawing the graph.
+    TempBucket b = {}, prev = {};
+    trendEach([&](uint32_t, const TempBucket &x) {
+      prev = b;
+      b = x;
+    });
+    if (b.lo >= trendLo && b.hi <= trendHi) {
+      trendColumn(d, total - 1, b, total > 1 ? prev.avg : TEMP_NONE);
+      trendGap(d, total);
+      trendShown = total;
+    }
+  }
+
+  if (!trendValid || total != trendShown) {
+    d.clearDisplay();
+    trendScale();
+    int prev = TEMP_NONE;
+    trendEach([&](uint32_t k, const TempBucket &b) {
+      trendColumn(d, k, b, prev);
+      prev = b.avg;
+    });
+    trendGap(d, total);
+    trendValid = false;  // the header went with the clear
+  }
+  trendHeader(d);
+  trendValid = true;
+  trendShown = total;
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+// WiFi connection as a polled state machine. Nothing here waits: wifiPoll()
+// looks at WiFi.status() and moves between states, so a bad password or a
+// dropped AP only ever costs a status check.
+//
+//   IDLE --wifiStart()--> CONNECTING (directed, from the cache)
+//                             |    |
+//                     no AP/timeout  +-- link up ------> CONNECTED
+//                             v                        ^    |
+//                          SCANNING --> CONNECTING ----+    | link lost:
+//                                    (each known network    | directed
+//                                     the scan found)       | again
+//                                         |                 |
+//                                     none left             |
+//                                         v                 |
+//                                      FAILED <-------------+ (if that fails)
+//                                         |
+//                             backoff expires: wifiStart() again
+//
+// The store keeps up to WIFI_MAX_NETWORKS networks. Each remembers the
+// BSSID, channel and IP configuration of its last connect, so the common
+// case is a directed connect on one channel with no scan and no DHCP. A
+// cached lease is reused for at most WIFI_LEASE_REUSES connects before DHCP
+// runs again to renew it. Per-network connect times pick the network tried
+// first: the fastest, unless it has been failing.
+//
+// Fresh credentials are added to the store only once they connect. If they
+// fail, retries go back to the networks already known.
+
+#define WIFI_MAX_NETWORKS       4
+#define WIFI_CONNECT_TIMEOUT_MS 10000
+#define WIFI_DIRECT_TIMEOUT_MS  3000
+#define WIFI_SCAN_TIMEOUT_MS    8000
+#define WIFI_LEASE_REUSES       8
+#define WIFI_RETRY_MIN_MS       2000UL
+#define WIFI_RETRY_MAX_MS       (5UL * 60000UL)
+#define WIFI_STORE_MAGIC        0x31494657UL  // "WFI1"
+
+enum WifiState { WIFI_IDLE, WIFI_SCANNING, WIFI_CONNECTING, WIFI_CONNECTED, WIFI_FAILED };
+
+struct WifiNetwork {
+  char ssid[33];
+  char pass[64];
+  uint8_t bssid[6];
+  uint8_t channel;          // 0: no cached AP
+  uint8_t leaseUses;        // connects on the cached lease since DHCP
+  uint32_t ip, gateway, subnet, dns;   // ip 0: no cached lease
+  uint16_t connects, fails;
+  uint8_t failStreak;
+  uint32_t avgMs;           // connect time, moving average
+  uint32_t lastMs;
+  uint32_t lastUsed;        // WifiStore::seq at the last connect
+};
+
+struct WifiStore {
+  uint32_t magic;
+  uint32_t seq;
+  uint8_t count;
+  WifiNetwork net[WIFI_MAX_NETWORKS];
+};
+
+typedef void (*WifiChangeFn)(WifiState state);
+typedef void (*WifiSaveFn)();
+
+WifiStore wifiStore;
+WifiState wifiState = WIFI_IDLE;
+WifiChangeFn wifiOnChange = nullptr;   // every state change
+WifiSaveFn wifiOnSave = nullptr;       // the store changed
+
+// The network being tried or in use: a store entry, or wifiFreshNet
+WifiNetwork *wifiNet = nullptr;
+WifiNetwork wifiFreshNet;
+bool wifiFresh = false;                // wifiFreshNet not yet proven
+bool wifiDirect = false;               // connecting on cached BSSID/channel
+bool wifiStaticIp = false;             // and on the cached lease
+
+// Known networks the last scan found, best first
+struct WifiCandidate {
+  WifiNetwork *net;
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+WifiCandidate wifiCandidates[WIFI_MAX_NETWORKS];
+uint8_t wifiCandidateCount = 0, wifiCandidatePos = 0;
+
+unsigned long wifiSince = 0;           // entered the current state
+unsigned long wifiStartedAt = 0;       // wifiStart(), for connect times
+unsigned long wifiRetryMs = WIFI_RETRY_MIN_MS;
+uint32_t wifiAttempts = 0;
+
+const char *wifiStateName(WifiState s) {
+  switch (s) {
+    case WIFI_IDLE: return "idle";
+    case WIFI_SCANNING: return "scanning";
+    case WIFI_CONNECTING: return "connecting";
+    case WIFI_CONNECTED: return "connected";
+    default: return "failed";
+  }
+}
+
+void wifiSetState(WifiState s) {
+  if (s == wifiState) return;
+  wifiState = s;
+  wifiSince = millis();
+  if (wifiOnChange) wifiOnChange(s);
+}
+
+// --- Store ---
+
+WifiNetwork *wifiFind(const char *ssid) {
+  for (int i = 0; i < wifiStore.count; i++)
+    if (!strcmp(wifiStore.net[i].ssid, ssid)) return &wifiStore.net[i];
+  return nullptr;
+}
+
+// Networks that keep failing go last, then the fastest first
+uint32_t wifiRank(const WifiNetwork &n) {
+  return (uint32_t)n.failStreak << 24 | min<uint32_t>(n.avgMs, 0xFFFFFF);
+}
+
+WifiNetwork *wifiBest() {
+  WifiNetwork *best = nullptr;
+  for (int i = 0; i < wifiStore.count; i++)
+    if (!best || wifiRank(wifiStore.net[i]) < wifiRank(*best)) best = &wifiStore.net[i];
+  return best;
+}
+
+// n proved itself: keep it, replacing the least recently used entry if full
+WifiNetwork *wifiKeep(const WifiNetwork &n) {
+  WifiNetwork *slot = wifiFind(n.ssid);
+  if (!slot && wifiStore.count < WIFI_MAX_NETWORKS) slot = &wifiStore.net[wifiStore.count++];
+  if (!slot) {
+    slot = &wifiStore.net[0];
+    for (int i = 1; i < WIFI_MAX_NETWORKS; i++)
+      if (wifiStore.net[i].lastUsed < slot->lastUsed) slot = &wifiStore.net[i];
+  }
+  *slot = n;
+  return slot;
+}
+
+void wifiStoreSave(Preferences &prefs) {
+  prefs.putBytes("store", &wifiStore, sizeof(wifiStore));
+}
+
+// Loads the store; a lone ssid/pass pair from before the store becomes its
+// first network
+void wifiStoreLoad(Preferences &prefs) {
+  if (prefs.getBytesLength("store") == sizeof(wifiStore) && prefs.getBytes("store", &wifiStore, sizeof(wifiStore)) &&
+      wifiStore.magic == WIFI_STORE_MAGIC)
+    return;
+  memset(&wifiStore, 0, sizeof(wifiStore));
+  wifiStore.magic = WIFI_STORE_MAGIC;
+  String ssid = prefs.getString("ssid", "");
+  if (ssid == "") return;
+  WifiNetwork n = {};
+  strncpy(n.ssid, ssid.c_str(), sizeof(n.ssid) - 1);
+  strncpy(n.pass, prefs.getString("pass", "").c_str(), sizeof(n.pass) - 1);
+  wifiKeep(n);
+}
+
+// --- Connecting ---
+
+// Directed connect to the AP in the cache, on the cached lease if it is
+// still good for another reuse
+void wifiConnectDirect(WifiNetwork *n) {
+  wifiAttempts++;
+  wifiNet = n;
+  wifiDirect = true;
+  wifiStaticIp = n->ip && n->leaseUses < WIFI_LEASE_REUSES;
+  if (wifiStaticIp) WiFi.config(IPAddress(n->ip), IPAddress(n->gateway), IPAddress(n->subnet), IPAddress(n->dns));
+  else WiFi.config(IPAddress(), IPAddress(), IPAddress());
+  WiFi.begin(n->ssid, n->pass, n->channel, n->bssid);
+  wifiSetState(WIFI_CONNECTING);
+}
+
+void wifiScan() {
+  WiFi.disconnect();
+  WiFi.scanNetworks(true);
+  wifiSetState(WIFI_SCANNING);
+}
+
+void wifiFail() {
+  WiFi.disconnect();
+  if (wifiFresh && wifiStore.count) wifiFresh = false;  // back to the known networks
+  wifiSetState(WIFI_FAILED);
+}
+
+// Next network the scan found, on DHCP; FAILED when there are none left
+void wifiNextCandidate() {
+  if (wifiCandidatePos >= wifiCandidateCount) {
+    wifiFail();
+    return;
+  }
+  const WifiCandidate &c = wifiCandidates[wifiCandidatePos++];
+  wifiAttempts++;
+  wifiNet = c.net;
+  wifiDirect = false;
+  wifiStaticIp = false;
+  WiFi.config(IPAddress(), IPAddress(), IPAddress());
+  WiFi.begin(c.net->ssid, c.net->pass, c.channel, c.bssid);
+  wifiSetState(WIFI_CONNECTING);
+}
+
+// Candidates from a finished scan: the networks we know (or the fresh one),
+// each at its strongest AP, in rank order
+void wifiPickCandidates(int found) {
+  wifiCandidateCount = wifiCandidatePos = 0;
+  int32_t rssi[WIFI_MAX_NETWORKS];
+  for (int i = 0; i < found; i++) {
+    String ssid = WiFi.SSID(i);
+    WifiNetwork *n = wifiFresh ? (ssid == wifiFreshNet.ssid ? &wifiFreshNet : nullptr) : wifiFind(ssid.c_str());
+    if (!n) continue;
+    int c = 0;
+    while (c < wifiCandidateCount && wifiCandidates[c].net != n) c++;
+    if (c == wifiCandidateCount) {
+      if (c == WIFI_MAX_NETWORKS) continue;
+      wifiCandidateCount++;
+    } else if (WiFi.RSSI(i) <= rssi[c]) {
+      continue;
+    }
+    wifiCandidates[c].net = n;
+    memcpy(wifiCandidates[c].bssid, WiFi.BSSID(i), 6);
+    wifiCandidates[c].channel = WiFi.channel(i);
+    rssi[c] = WiFi.RSSI(i);
+  }
+  WiFi.scanDelete();
+
+  for (int i = 1; i < wifiCandidateCount; i++)
+    for (int j = i; j > 0 && wifiRank(*wifiCandidates[j].net) < wifiRank(*wifiCandidates[j - 1].net); j--) {
+      WifiCandidate t = wifiCandidates[j];
+      wifiCandidates[j] = wifiCandidates[j - 1];
+      wifiCandidates[j - 1] = t;
+    }
+}
+
+// The best known network: directed if it has a cached AP, else a scan
+void wifiBegin() {
+  wifiStartedAt = millis();
+  if (wifiState == WIFI_CONNECTING || wifiState == WIFI_CONNECTED) WiFi.disconnect();
+  wifiState = WIFI_IDLE;  // so what follows reports a change
+  WifiNetwork *best = wifiFresh ? nullptr : wifiBest();
+  if (best && best->channel) wifiConnectDirect(best);
+  else wifiScan();
+}
+
+// Connects to the known networks; false if there are none
+bool wifiStart() {
+  if (!wifiStore.count) return false;
+  wifiFresh = false;
+  wifiRetryMs = WIFI_RETRY_MIN_MS;
+  wifiBegin();
+  return true;
+}
+
+// Credentials from provisioning, kept only if they connect
+void wifiAdd(const String &ssid, const String &pass) {
+  memset(&wifiFreshNet, 0, sizeof(wifiFreshNet));
+  strncpy(wifiFreshNet.ssid, ssid.c_str(), sizeof(wifiFreshNet.ssid) - 1);
+  strncpy(wifiFreshNet.pass, pass.c_str(), sizeof(wifiFreshNet.pass) - 1);
+  wifiFresh = true;
+  wifiRetryMs = WIFI_RETRY_MIN_MS;
+  wifiBegin();
+}
+
+// The link is up: cache where it went and how long it took
+void wifiConnected() {
+  WifiNetwork &n = *wifiNet;
+  memcpy(n.bssid, WiFi.BSSID(), 6);
+  n.channel = WiFi.channel();
+  if (wifiStaticIp) {
+    n.leaseUses++;
+  } else {
+    n.ip = WiFi.localIP();
+    n.gateway = WiFi.gatewayIP();
+    n.subnet = WiFi.subnetMask();
+    n.dns = WiFi.dnsIP();
+    n.leaseUses = 0;
+  }
+  n.lastMs = millis() - wifiStartedAt;
+  n.avgMs = n.connects ? (n.avgMs * 3 + n.lastMs) / 4 : n.lastMs;
+  n.connects++;
+  n.failStreak = 0;
+  n.lastUsed = ++wifiStore.seq;
+  if (wifiFresh) {
+    wifiNet = wifiKeep(n);
+    wifiFresh = false;
+  }
+  wifiRetryMs = WIFI_RETRY_MIN_MS;
+  if (wifiOnSave) wifiOnSave();
+  wifiSetState(WIFI_CONNECTED);
+}
+
+// Call every ~100 ms
+void wifiPoll() {
+  unsigned long now = millis();
+  switch (wifiState) {
+    case WIFI_IDLE:
+      break;
+
+    case WIFI_SCANNING: {
+      int found = WiFi.scanComplete();
+      if (found == WIFI_SCAN_RUNNING && now - wifiSince < WIFI_SCAN_TIMEOUT_MS) break;
+      wifiPickCandidates(max(found, 0));
+      wifiNextCandidate();
+      break;
+    }
+
+    case WIFI_CONNECTING: {
+      wl_status_t st = WiFi.status();
+      if (st == WL_CONNECTED) {
+        wifiConnected();
+        break;
+      }
+      unsigned long timeout = wifiDirect ? WIFI_DIRECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS;
+      if (st != WL_CONNECT_FAILED && st != WL_NO_SSID_AVAIL && now - wifiSince < timeout) break;
+      WiFi.disconnect();
+      if (wifiDirect) {
+        wifiScan();  // the cached AP isn't answering; look for any known one
+      } else {
+        wifiNet->fails++;
+        if (wifiNet->failStreak < 255) wifiNet->failStreak++;
+        wifiNextCandidate();
+      }
+      break;
+    }
+
+    case WIFI_CONNECTED:
+      // Straight back to the same AP the first time; backoff only if that fails
+      if (WiFi.status() != WL_CONNECTED) {
+        wifiRetryMs = WIFI_RETRY_MIN_MS;
+        WiFi.disconnect();
+        wifiStartedAt = now;
+        wifiConnectDirect(wifiNet);
+      }
+      break;
+
+    case WIFI_FAILED:
+      if (now - wifiSince >= wifiRetryMs) {
+        wifiRetryMs = min<unsigned long>(wifiRetryMs * 2, WIFI_RETRY_MAX_MS);
+        wifiBegin();
+      }
+      break;
+  }
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+// Only the metrics the sketch depends on: advance, glyph height, line height.
+struct GFXfont {
+  uint8_t advance;
+  uint8_t height;
+  uint8_t yAdvance;
+};
+
+// Subset of Adafruit_GFX with the same coordinate and text-cursor rules.
+// Text is rendered with stand-in glyphs of the right size: what matters on
+// the host is which pixels and pages a print() touches, not legibility.
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+  }
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+  }
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t i = x; i < x + w; i++) drawFastVLine(i, y, h, color);
+  }
+  virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+    if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+    int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2, ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) drawPixel(y0, x0, color); else drawPixel(x0, y0, color);
+      err -= dy;
+      if (err < 0) { y0 += ystep; err += dx; }
+    }
+  }
+
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+  }
+
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    drawPixel(x0, y0 + r, color); drawPixel(x0, y0 - r, color);
+    drawPixel(x0 + r, y0, color); drawPixel(x0 - r, y0, color);
+    while (x < y) {
+      if (f >= 0) { y--; ddy += 2; f += ddy; }
+      x++; ddx += 2; f += ddx;
+      drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+      drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+      drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+      drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+    }
+  }
+
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    for (int16_t dy = -r; dy <= r; dy++)
+      for (int16_t dx = -r; dx <= r; dx++)
+        if (dx * dx + dy * dy <= r * r + r) drawPixel(x0 + dx, y0 + dy, color);
+  }
+
+  void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+    int16_t minX = std::min({ x0, x1, x2 }), maxX = std::max({ x0, x1, x2 });
+    int16_t minY = std::min({ y0, y1, y2 }), maxY = std::max({ y0, y1, y2 });
+    for (int16_t y = minY; y <= maxY; y++)
+      for (int16_t x = minX; x <= maxX; x++) {
+        long a = (long)(x1 - x0) * (y - y0) - (long)(y1 - y0) * (x - x0);
+        long b = (long)(x2 - x1) * (y - y1) - (long)(y2 - y1) * (x - x1);
+        long c = (long)(x0 - x2) * (y - y2) - (long)(y0 - y2) * (x - x2);
+        if ((a >= 0 && b >= 0 && c >= 0) || (a <= 0 && b <= 0 && c <= 0)) drawPixel(x, y, color);
+      }
+  }
+
+  void drawBitmap(int16_t x, int16_t y, const uint8_t *bmp, int16_t w, int16_t h, uint16_t color) {
+    int16_t bw = (w + 7) / 8;
+    for (int16_t j = 0; j < h; j++)
+      for (int16_t i = 0; i < w; i++)
+        if (bmp[j * bw + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+  }
+
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  int16_t getCursorX() const { return cursorX; }
+  int16_t getCursorY() const { return cursorY; }
+  void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+  void setTextColor(uint16_t c) { textColor = c; textBg = c; }
+  void setTextColor(uint16_t c, uint16_t bg) { textColor = c; textBg = bg; }
+  void setTextWrap(bool w) { wrap = w; }
+  void setFont(const GFXfont *f = nullptr) {
+    // Adafruit_GFX shifts the cursor when switching between classic and custom fonts
+    if (f && !font) cursorY += 6;
+    else if (!f && font) cursorY -= 6;
+    font = f;
+  }
+  void setRotation(uint8_t) {}
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      cursorX = 0;
+      cursorY += font ? font->yAdvance * textSize : 8 * textSize;
+      return 1;
+    }
+    if (c == '\r') return 1;
+    if (!font) {
+      if (wrap && cursorX + 6 * textSize > _width) { cursorX = 0; cursorY += 8 * textSize; }
+      drawGlyph(cursorX, cursorY, c, 5, 7);
+      cursorX += 6 * textSize;
+    } else {
+      if (c != ' ') drawGlyph(cursorX, cursorY - font->height + 1, c, font->advance - 2, font->height);
+      cursorX += (c == ' ' ? font->advance / 2 : font->advance) * textSize;
+    }
+    return 1;
+  }
+
+protected:
+  int16_t _width, _height;
+  int16_t cursorX = 0, cursorY = 0;
+  uint8_t textSize = 1;
+  uint16_t textColor = 1, textBg = 1;
+  bool wrap = true;
+  const GFXfont *font = nullptr;
+
+  // Deterministic per-character pattern inside the glyph cell
+  void drawGlyph(int16_t x, int16_t y, uint8_t c, int16_t w, int16_t h) {
+    if (textBg != textColor)
+      fillRect(x, y, (w + 1) * textSize, (h + 1) * textSize, textBg);
+    if (c == ' ') return;
+    uint32_t bits = c * 2654435761u;
+    for (int16_t i = 0; i < w; i++)
+      for (int16_t j = 0; j < h; j++) {
+        bool edge = i == 0 || j == 0 || i == w - 1 || j == h - 1;
+        bool on = edge ? ((i + j) & 1) == 0 : (bits >> ((i * h + j) & 31)) & 1;
+        if (on) fillRect(x + i * textSize, y + j * textSize, textSize, textSize, textColor);
+      }
+  }
+};
+
+#endif
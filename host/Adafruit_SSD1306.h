@@ -0,0 +1,113 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK   0
+#define SSD1306_WHITE   1
+#define SSD1306_INVERSE 2
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_DISPLAYOFF   0xAE
+#define SSD1306_DISPLAYON    0xAF
+#define SSD1306_MEMORYMODE   0x20
+#define SSD1306_COLUMNADDR   0x21
+#define SSD1306_PAGEADDR     0x22
+#define SSD1306_SETSTARTLINE 0x40
+
+#define SSD1306_RIGHT_HORIZONTAL_SCROLL              0x26
+#define SSD1306_LEFT_HORIZONTAL_SCROLL               0x27
+#define SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL 0x29
+#define SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL  0x2A
+#define SSD1306_DEACTIVATE_SCROLL                    0x2E
+#define SSD1306_ACTIVATE_SCROLL                      0x2F
+
+// In-memory SSD1306: same page-format buffer as the real driver.
+// display() copies the buffer to `panel` and bills a full-frame transfer
+// to the Wire counters.
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi = &Wire, int8_t rst = -1, uint32_t clkDuring = 400000UL,
+                   uint32_t clkAfter = 100000UL)
+    : Adafruit_GFX(w, h), wire(twi) {
+    buffer = (uint8_t *)calloc(w * ((h + 7) / 8), 1);
+    panel = (uint8_t *)calloc(w * ((h + 7) / 8), 1);
+  }
+  ~Adafruit_SSD1306() { free(buffer); free(panel); }
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0, bool reset = true, bool periphBegin = true) {
+    i2caddr = addr ? addr : 0x3C;
+    clearDisplay();
+    displayOn = true;
+    return true;
+  }
+
+  void display() {
+    memcpy(panel, buffer, bufferSize());
+    static const uint8_t cmds[] = { SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, 127 };
+    for (uint8_t c : cmds) ssd1306_command(c);
+    size_t n = bufferSize();
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x40);
+    wire->write(buffer, n);
+    wire->endTransmission();
+    fullFrames++;
+  }
+
+  void clearDisplay() { memset(buffer, 0, bufferSize()); }
+  void invertDisplay(bool i) { ssd1306_command(i ? 0xA7 : 0xA6); }
+  void dim(bool) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t &b = buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+      case SSD1306_WHITE: b |= bit; break;
+      case SSD1306_BLACK: b &= ~bit; break;
+      case SSD1306_INVERSE: b ^= bit; break;
+    }
+  }
+
+  bool getPixel(int16_t x, int16_t y) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+    return buffer[x + (y / 8) * _width] & (1 << (y & 7));
+  }
+
+  uint8_t *getBuffer() { return buffer; }
+
+  void ssd1306_command(uint8_t c) {
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    wire->write(c);
+    wire->endTransmission();
+    if (c == SSD1306_DISPLAYOFF) displayOn = false;
+    if (c == SSD1306_DISPLAYON) displayOn = true;
+    if (commandHook) commandHook(c);
+  }
+
+  void startscrollright(uint8_t start, uint8_t stop) {
+    const uint8_t cmds[] = { SSD1306_RIGHT_HORIZONTAL_SCROLL, 0, start, 0, stop, 0, 0xFF, SSD1306_ACTIVATE_SCROLL };
+    for (uint8_t c : cmds) ssd1306_command(c);
+  }
+  void startscrollleft(uint8_t start, uint8_t stop) {
+    const uint8_t cmds[] = { SSD1306_LEFT_HORIZONTAL_SCROLL, 0, start, 0, stop, 0, 0xFF, SSD1306_ACTIVATE_SCROLL };
+    for (uint8_t c : cmds) ssd1306_command(c);
+  }
+  void stopscroll() { ssd1306_command(SSD1306_DEACTIVATE_SCROLL); }
+
+  // Host only
+  uint8_t *panel;
+  bool displayOn = false;
+  uint32_t fullFrames = 0;
+  void (*commandHook)(uint8_t) = nullptr;
+  size_t bufferSize() const { return _width * ((_height + 7) / 8); }
+
+protected:
+  TwoWire *wire;
+  uint8_t *buffer;
+  uint8_t i2caddr = 0x3C;
+};
+
+#endif
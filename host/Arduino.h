@@ -0,0 +1,178 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the Arduino core. Time runs on a virtual clock that only
+// moves when the sketch calls delay() or the simulator advances it, so runs
+// are deterministic and as fast as the CPU allows.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+#include <time.h>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+#define CHANGE  3
+#define FALLING 2
+#define RISING  1
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define DEC 10
+#define HEX 16
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+namespace host {
+extern uint64_t nowUs;            // virtual clock
+extern uint8_t pinLevel[64];      // what digitalRead() returns
+extern uint64_t delayedUs;        // time spent inside delay()
+extern void (*isr[64])();
+extern uint8_t isrMode[64];
+void setPin(uint8_t pin, uint8_t level);  // drives edges into attached ISRs
+extern void (*tick)();             // runs after every clock advance
+void advance(uint64_t us);
+uint32_t nextRandom();
+void seedRandom(uint32_t s);
+}
+
+inline unsigned long millis() { return (unsigned long)(host::nowUs / 1000); }
+inline unsigned long micros() { return (unsigned long)host::nowUs; }
+inline void delay(unsigned long ms) { host::delayedUs += ms * 1000ULL; host::advance(ms * 1000ULL); }
+inline void delayMicroseconds(unsigned int us) { host::delayedUs += us; host::advance(us); }
+inline void yield() {}
+inline int digitalRead(uint8_t pin) { return host::pinLevel[pin & 63]; }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void pinMode(uint8_t pin, uint8_t) { if (!host::pinLevel[pin & 63]) host::pinLevel[pin & 63] = HIGH; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int pin, void (*fn)(), int mode) { host::isr[pin & 63] = fn; host::isrMode[pin & 63] = mode; }
+inline void detachInterrupt(int pin) { host::isr[pin & 63] = nullptr; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline long random(long howbig) { return howbig <= 0 ? 0 : (long)(host::nextRandom() % (uint32_t)howbig); }
+inline long random(long lo, long hi) { return lo >= hi ? lo : lo + random(hi - lo); }
+inline void randomSeed(unsigned long s) { host::seedRandom((uint32_t)s); }
+inline uint32_t esp_random() { return host::nextRandom(); }
+inline long map(long x, long in0, long in1, long out0, long out1) {
+  return (x - in0) * (out1 - out0) / (in1 - in0) + out0;
+}
+template <typename T> T constrain(T x, T a, T b) { return x < a ? a : (x > b ? b : x); }
+
+// Real elapsed time scaled to a 240 MHz core, so profiles of host code
+// read like device profiles in magnitude (not in absolute value)
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+class EspClass {
+public:
+  uint32_t getCycleCount() {
+    using namespace std::chrono;
+    return (uint32_t)(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() * 240 / 1000);
+  }
+};
+extern EspClass ESP;
+
+class String {
+public:
+  String() {}
+  String(const char *s) : s(s ? s : "") {}
+  String(const std::string &str) : s(str) {}
+  String(char c) : s(1, c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned int v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(float v, int digits = 2) { fmt(v, digits); }
+  String(double v, int digits = 2) { fmt(v, digits); }
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < s.size() ? String(s.substr(from, to > from ? to - from : 0)) : String();
+  }
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const char *o) const { return s != o; }
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+  friend String operator+(const char *a, const String &b) { return String(std::string(a) + b.s); }
+  friend String operator+(const String &a, const char *b) { return String(a.s + b); }
+
+private:
+  std::string s;
+  void fmt(double v, int digits) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    s = buf;
+  }
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    size_t r = 0;
+    while (n--) r += write(*buf++);
+    return r;
+  }
+  size_t print(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+  size_t print(const String &str) { return print(str.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return printNum((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return printNum((long)v, base); }
+  size_t print(long v, int base = DEC) { return printNum(v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printNum((long)v, base); }
+  size_t print(double v, int digits = 2) { return print(String(v, digits)); }
+  size_t println() { return write('\n'); }
+  template <typename T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  size_t printf(const char *f, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, f);
+    int n = vsnprintf(buf, sizeof(buf), f, ap);
+    va_end(ap);
+    print(buf);
+    return n;
+  }
+
+private:
+  size_t printNum(long v, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%ld", v);
+    return print(buf);
+  }
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { if (enabled) fputc(c, stderr); return 1; }
+  size_t write(const uint8_t *buf, size_t n) override { if (enabled) fwrite(buf, 1, n, stderr); return n; }
+  int available() { return 0; }
+  int read() { return -1; }
+  void flush() {}
+  operator bool() const { return true; }
+  bool enabled = true;
+};
+
+extern HardwareSerial Serial;
+
+#endif
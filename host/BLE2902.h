@@ -0,0 +1,6 @@
+#ifndef HOST_BLE2902_H
+#define HOST_BLE2902_H
+
+#include "BLEDevice.h"
+
+#endif
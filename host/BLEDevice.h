@@ -0,0 +1,86 @@
+#ifndef HOST_BLEDEVICE_H
+#define HOST_BLEDEVICE_H
+
+#include "Arduino.h"
+#include <vector>
+
+namespace host { extern unsigned long bleInitMs; }
+
+// Just enough of the ESP32 BLE API for the provisioning service. The
+// simulator writes characteristics directly to fake a phone.
+class BLECharacteristic;
+
+class BLECharacteristicCallbacks {
+public:
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onWrite(BLECharacteristic *c) {}
+};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+
+  BLECharacteristic(const char *uuid) : uuid(uuid) {}
+  void setCallbacks(BLECharacteristicCallbacks *cb) { callbacks = cb; }
+  String getValue() const { return value; }
+  void setValue(const String &v) { value = v; }
+
+  // Host only: what a phone write looks like to the sketch
+  void write(const String &v) { value = v; if (callbacks) callbacks->onWrite(this); }
+
+  String uuid;
+
+private:
+  String value;
+  BLECharacteristicCallbacks *callbacks = nullptr;
+};
+
+class BLEAdvertising {
+public:
+  void start() {}
+  void stop() {}
+};
+
+class BLEService {
+public:
+  BLEService(const char *uuid) : uuid(uuid) {}
+  BLECharacteristic *createCharacteristic(const char *uuid, uint32_t props) {
+    chars.push_back(new BLECharacteristic(uuid));
+    return chars.back();
+  }
+  void start() {}
+  String uuid;
+  std::vector<BLECharacteristic *> chars;
+};
+
+class BLEServer {
+public:
+  BLEService *createService(const char *uuid) {
+    services.push_back(new BLEService(uuid));
+    return services.back();
+  }
+  BLEAdvertising *getAdvertising();
+  std::vector<BLEService *> services;
+};
+
+class BLEDevice {
+public:
+  static void init(const char *name) { delay(host::bleInitMs); }  // controller bring-up
+  static BLEServer *createServer() { return server(); }
+  static BLEAdvertising *getAdvertising() { static BLEAdvertising a; return &a; }
+  static BLEServer *server() { static BLEServer s; return &s; }
+
+  // Host only: find a characteristic by UUID
+  static BLECharacteristic *find(const char *uuid) {
+    for (auto *svc : server()->services)
+      for (auto *c : svc->chars)
+        if (c->uuid == uuid) return c;
+    return nullptr;
+  }
+};
+
+inline BLEAdvertising *BLEServer::getAdvertising() { return BLEDevice::getAdvertising(); }
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef COUNTING_BUS_H
+#define COUNTING_BUS_H
+
+#include "../Play_Box/PageFlush.h"
+
+// Host stand-in for the I2C link: counts bytes the way WireBus puts them on
+// the wire (address + control byte per transaction, 31 data bytes max) and
+// mirrors the controller RAM so results can be checked. Content scroll
+// rotates the band: what a real controller shifts in at the trailing edge
+// isn't specified, and PageFlusher resends those columns either way.
+//
+// Time is timeUs: waits advance it and the caller moves it along with its
+// own clock. Content scroll commands closer together than checkGapUs are
+// counted in gapViolations.
+class CountingBus : public DisplayBus {
+public:
+  uint8_t gdram[FLUSH_BYTES] = {};
+  uint32_t transactions = 0, scrolls = 0;
+  uint32_t timeUs = 0, waitedUs = 0, checkGapUs = 0, gapViolations = 0;
+
+  uint32_t nowUs() override { return timeUs; }
+  void waitUs(uint32_t us) override {
+    timeUs += us;
+    waitedUs += us;
+  }
+
+  void command(const uint8_t *cmds, uint8_t n) override {
+    for (uint8_t i = 0; i < n; i++) {
+      uint8_t c = cmds[i];
+      if (c == SSD_COLUMNADDR && i + 2 < n) { col0 = cmds[i + 1]; col1 = cmds[i + 2]; i += 2; }
+      else if (c == SSD_PAGEADDR && i + 2 < n) { page0 = cmds[i + 1]; page1 = cmds[i + 2]; i += 2; }
+      else if ((c == SSD_SCROLL_LEFT_ONE || c == SSD_SCROLL_RIGHT_ONE) && i + 7 < n) {
+        contentScroll(c == SSD_SCROLL_LEFT_ONE, cmds[i + 2], cmds[i + 4], cmds[i + 6], cmds[i + 7]);
+        i += 7;
+      }
+    }
+    col = col0; page = page0;
+    bytesSent += 2 + n;
+    transactions++;
+  }
+
+  void data(const uint8_t *bytes, uint16_t n) override {
+    for (uint16_t i = 0; i < n; i++) {
+      if (page < FLUSH_PAGES) gdram[page * FLUSH_WIDTH + col] = bytes[i];
+      if (++col > col1) { col = col0; if (++page > page1) page = page0; }
+    }
+    uint16_t chunks = (n + 30) / 31;
+    bytesSent += n + 2 * chunks;
+    transactions += chunks;
+  }
+
+private:
+  uint32_t lastScrollUs = 0;
+
+  void contentScroll(bool left, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    if (scrolls && timeUs - lastScrollUs < checkGapUs) gapViolations++;
+    lastScrollUs = timeUs;
+    scrolls++;
+    for (uint8_t p = p0; p <= p1 && p < FLUSH_PAGES; p++) {
+      uint8_t *row = gdram + p * FLUSH_WIDTH;
+      if (left) {
+        uint8_t first = row[c0];
+        memmove(row + c0, row + c0 + 1, c1 - c0);
+        row[c1] = first;
+      } else {
+        uint8_t last = row[c1];
+        memmove(row + c0 + 1, row + c0, c1 - c0);
+        row[c0] = last;
+      }
+    }
+  }
+
+  uint8_t col0 = 0, col1 = FLUSH_WIDTH - 1, page0 = 0, page1 = FLUSH_PAGES - 1;
+  uint8_t col = 0, page = 0;
+};
+
+#endif
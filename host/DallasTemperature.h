@@ -0,0 +1,32 @@
+#ifndef HOST_DALLASTEMPERATURE_H
+#define HOST_DALLASTEMPERATURE_H
+
+#include "Arduino.h"
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+namespace host { extern float temperatureC; }
+
+// A 12-bit conversion takes 750 ms; blocking requests burn it on the clock.
+class DallasTemperature {
+public:
+  DallasTemperature(OneWire *) {}
+  void begin() {}
+  void setWaitForConversion(bool w) { wait = w; }
+  bool getWaitForConversion() const { return wait; }
+  void setResolution(uint8_t) {}
+  void requestTemperatures() {
+    requestedAt = millis();
+    if (wait) delay(750);
+  }
+  bool isConversionComplete() { return millis() - requestedAt >= 750; }
+  float getTempCByIndex(uint8_t) { return host::temperatureC; }
+  int16_t millisToWaitForConversion(uint8_t = 12) { return 750; }
+
+private:
+  bool wait = true;
+  unsigned long requestedAt = 0;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_FREESANS9PT7B_H
+#define HOST_FREESANS9PT7B_H
+
+#include "../Adafruit_GFX.h"
+
+// Metrics only: glyphs are drawn as stand-in patterns of FreeSans size.
+const GFXfont FreeSans9pt7b = { 10, 13, 22 };
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{ a, b, c, d } {}
+  IPAddress(uint32_t v) { memcpy(bytes, &v, 4); }
+  uint8_t operator[](int i) const { return bytes[i & 3]; }
+  uint8_t &operator[](int i) { return bytes[i & 3]; }
+  operator uint32_t() const { uint32_t v; memcpy(&v, bytes, 4); return v; }
+  bool operator==(const IPAddress &o) const { return !memcmp(bytes, o.bytes, 4); }
+  bool operator!=(const IPAddress &o) const { return !(*this == o); }
+  bool fromString(const char *s) {
+    unsigned a, b, c, d;
+    char tail;
+    if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+      return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(buf);
+  }
+
+private:
+  uint8_t bytes[4] = { 0, 0, 0, 0 };
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_JUMP_BOT_H
+#define HOST_JUMP_BOT_H
+
+#include "JumpGame.h"
+
+// Shared by the host tools that play Jump unattended. Holds pin 5 while
+// the next obstacle is 50-150 ms from the player; call it before each
+// jumpUpdate(), with buttonsFed set so the pins are ignored.
+inline void jumpBotPress() {
+  int next = jumpNextObstacle();
+  int arrivalMs = (jumpObstacles[next].x - jumpGroundOffset() - 10) * 1000 * FX_ONE / jumpCamera.vx;
+  buttonStates[0].down = arrivalMs >= 50 && arrivalMs <= 150;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HOST_NTPCLIENT_H
+#define HOST_NTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFiUdp.h"
+
+// Time is host::epochBase plus virtual millis(); update() costs `syncMs`.
+namespace host { extern unsigned long epochBase; extern unsigned long ntpSyncMs; }
+
+class NTPClient {
+public:
+  NTPClient(WiFiUDP &udp, const char *server, long offset = 0) : offset(offset) {}
+  void begin() {}
+  bool update() {
+    if (synced && millis() - lastSync < 60000) return false;
+    return forceUpdate();
+  }
+  bool forceUpdate() {
+    delay(host::ntpSyncMs);
+    synced = true;
+    lastSync = millis();
+    return true;
+  }
+  bool isTimeSet() const { return synced; }
+  unsigned long getEpochTime() const { return (synced ? host::epochBase : 0) + offset + millis() / 1000; }
+  int getHours() const { return (getEpochTime() % 86400L) / 3600; }
+  int getMinutes() const { return (getEpochTime() % 3600) / 60; }
+  int getSeconds() const { return getEpochTime() % 60; }
+  String getFormattedTime() const {
+    char buf[9];
+    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", getHours(), getMinutes(), getSeconds());
+    return String(buf);
+  }
+  void setTimeOffset(long o) { offset = o; }
+
+private:
+  long offset;
+  bool synced = false;
+  unsigned long lastSync = 0;
+};
+
+#endif
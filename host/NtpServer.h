@@ -0,0 +1,101 @@
+#ifndef HOST_NTPSERVER_H
+#define HOST_NTPSERVER_H
+
+// NTP stand-in on a loopback UDP socket, run from host::tick on the virtual
+// clock. A round trip takes `delayMs`, split evenly between the legs, plus
+// up to `jitterMs` more on the return leg; `lossPct` of requests are
+// dropped. Its time is true time, against which the device clock runs
+// `skewPpm` fast.
+
+#include "Arduino.h"
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace host { extern unsigned long epochBase; }
+
+class NtpServer {
+public:
+  uint32_t delayMs = 20, jitterMs = 0, lossPct = 0;
+  int32_t skewPpm = 0;
+  uint32_t requests = 0, dropped = 0;
+
+  // Binds an ephemeral loopback port; returns it, 0 on failure
+  uint16_t begin(uint32_t seed = 1) {
+    rng = seed ? seed : 1;
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return 0;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr *)&a, sizeof(a)) < 0) return 0;
+    socklen_t len = sizeof(a);
+    getsockname(fd, (sockaddr *)&a, &len);
+    return ntohs(a.sin_port);
+  }
+
+  // True unix ms; the device's millis() runs skewPpm fast against it
+  uint64_t trueMs() const {
+    int64_t local = host::nowUs / 1000;
+    return host::epochBase * 1000ULL + local - local * skewPpm / 1000000;
+  }
+
+  void poll() {
+    if (fd < 0) return;
+    uint8_t p[48];
+    sockaddr_in from;
+    socklen_t len = sizeof(from);
+    while (recvfrom(fd, p, sizeof(p), 0, (sockaddr *)&from, &len) == (ssize_t)sizeof(p)) {
+      requests++;
+      if (next() % 100 < lossPct) { dropped++; continue; }
+      uint32_t extra = jitterMs ? next() % (jitterMs + 1) : 0;
+      Reply r;
+      r.to = from;
+      r.dueUs = host::nowUs + (delayMs + extra) * 1000ULL;
+      memset(r.p, 0, sizeof(r.p));
+      r.p[0] = 0x24;                 // LI 0, version 4, server
+      r.p[1] = 1;                    // stratum
+      memcpy(r.p + 24, p + 40, 8);   // originate = client's transmit
+      putTime(r.p + 32, trueMs() + delayMs / 2);
+      putTime(r.p + 40, trueMs() + delayMs / 2);
+      pending.push_back(r);
+    }
+    for (size_t i = 0; i < pending.size();) {
+      if (pending[i].dueUs > host::nowUs) { i++; continue; }
+      sendto(fd, pending[i].p, sizeof(pending[i].p), 0, (sockaddr *)&pending[i].to, sizeof(pending[i].to));
+      pending.erase(pending.begin() + i);
+    }
+  }
+
+private:
+  struct Reply {
+    sockaddr_in to;
+    uint64_t dueUs;
+    uint8_t p[48];
+  };
+  int fd = -1;
+  uint32_t rng = 1;
+  std::vector<Reply> pending;
+
+  uint32_t next() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  static void putTime(uint8_t *p, uint64_t unixMs) {
+    uint32_t sec = unixMs / 1000 + 2208988800ULL;
+    uint32_t frac = ((unixMs % 1000) << 32) / 1000;
+    for (int i = 0; i < 4; i++) {
+      p[i] = sec >> (24 - 8 * i);
+      p[4 + i] = frac >> (24 - 8 * i);
+    }
+  }
+};
+
+#endif
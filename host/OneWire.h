@@ -0,0 +1,11 @@
+#ifndef HOST_ONEWIRE_H
+#define HOST_ONEWIRE_H
+
+#include "Arduino.h"
+
+class OneWire {
+public:
+  OneWire(uint8_t pin) {}
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+#include <map>
+#include <vector>
+
+// Namespaced key/value store kept in memory for the life of the process.
+class Preferences {
+public:
+  bool begin(const char *ns, bool readOnly = false) { space = ns; return true; }
+  void end() {}
+  bool clear() { store()[space].clear(); return true; }
+  bool remove(const char *key) { return store()[space].erase(key) > 0; }
+  bool isKey(const char *key) { return store()[space].count(key) > 0; }
+
+  size_t putString(const char *key, const String &v) { return putBytes(key, v.c_str(), v.length() + 1); }
+  String getString(const char *key, const String &def = String()) {
+    auto &m = store()[space];
+    auto it = m.find(key);
+    return it == m.end() ? def : String((const char *)it->second.data());
+  }
+
+  size_t putBytes(const char *key, const void *v, size_t n) {
+    store()[space][key].assign((const uint8_t *)v, (const uint8_t *)v + n);
+    writes++;
+    return n;
+  }
+  size_t getBytesLength(const char *key) {
+    auto &m = store()[space];
+    auto it = m.find(key);
+    return it == m.end() ? 0 : it->second.size();
+  }
+  size_t getBytes(const char *key, void *buf, size_t n) {
+    auto &m = store()[space];
+    auto it = m.find(key);
+    if (it == m.end()) return 0;
+    n = std::min(n, it->second.size());
+    memcpy(buf, it->second.data(), n);
+    return n;
+  }
+
+  template <typename T> size_t putT(const char *key, T v) { return putBytes(key, &v, sizeof(v)); }
+  template <typename T> T getT(const char *key, T def) {
+    T v;
+    return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : def;
+  }
+  size_t putUInt(const char *key, uint32_t v) { return putT(key, v); }
+  uint32_t getUInt(const char *key, uint32_t def = 0) { return getT(key, def); }
+  size_t putULong(const char *key, uint32_t v) { return putT(key, v); }
+  uint32_t getULong(const char *key, uint32_t def = 0) { return getT(key, def); }
+  size_t putInt(const char *key, int32_t v) { return putT(key, v); }
+  int32_t getInt(const char *key, int32_t def = 0) { return getT(key, def); }
+  size_t putULong64(const char *key, uint64_t v) { return putT(key, v); }
+  uint64_t getULong64(const char *key, uint64_t def = 0) { return getT(key, def); }
+  size_t putUChar(const char *key, uint8_t v) { return putT(key, v); }
+  uint8_t getUChar(const char *key, uint8_t def = 0) { return getT(key, def); }
+
+  static uint32_t writes;
+
+private:
+  std::string space;
+  static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> &store() {
+    static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> s;
+    return s;
+  }
+};
+
+#endif
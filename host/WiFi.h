@@ -0,0 +1,150 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <vector>
+
+namespace host { extern String dnsAnswer; }
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+// Access points in range, with the latencies a connect pays in virtual time:
+//   full scan (begin() without a channel, or scanNetworks())  scanMs
+//   one-channel probe (begin() with a channel)                 channelScanMs
+//   authentication and association                             assocMs, plus
+//                                                              the AP's slowMs
+//   DHCP, unless config() set a static address                 dhcpMs
+// A directed begin() (channel and BSSID) to an AP that isn't there fails
+// with WL_NO_SSID_AVAIL after the probe; a wrong password fails with
+// WL_CONNECT_FAILED after association. An AP with an empty password takes
+// any password.
+class WiFiClass {
+public:
+  struct AccessPoint {
+    String ssid, pass;
+    uint8_t bssid[6];
+    uint8_t channel;
+    int32_t rssi;
+    bool on;
+    unsigned long slowMs;   // a busy AP answers late
+  };
+
+  wl_status_t begin(const char *ssid, const char *pass = nullptr, int32_t channel = 0, const uint8_t *bssid = nullptr,
+                    bool connect = true) {
+    begins++;
+    st = WL_DISCONNECTED;
+    connecting = connect;
+    beganAt = millis();
+    target = -1;
+    for (size_t i = 0; i < aps.size(); i++) {
+      const AccessPoint &ap = aps[i];
+      if (!available || !ap.on || ap.ssid != ssid) continue;
+      if (channel && ap.channel != channel) continue;
+      if (bssid && memcmp(ap.bssid, bssid, 6)) continue;
+      if (target < 0 || ap.rssi > aps[target].rssi) target = i;
+    }
+    String p = pass ? pass : "";
+    unsigned long find = channel ? channelScanMs : scanMs;
+    if (target < 0) {
+      doneMs = find;
+      result = WL_NO_SSID_AVAIL;
+    } else if (aps[target].pass != "" && aps[target].pass != p) {
+      doneMs = find + assocMs + aps[target].slowMs;
+      result = WL_CONNECT_FAILED;
+    } else {
+      doneMs = find + assocMs + aps[target].slowMs + (staticIp ? 0 : dhcpMs);
+      result = WL_CONNECTED;
+      if (!staticIp) dhcps++;
+    }
+    if (!channel) scans++;
+    return st;
+  }
+  bool disconnect(bool = false) { st = WL_DISCONNECTED; connecting = false; return true; }
+  bool mode(int) { return true; }
+  bool setAutoReconnect(bool) { return true; }
+  wl_status_t status() {
+    if (connecting && millis() - beganAt >= doneMs) {
+      connecting = false;
+      st = result;
+      if (st == WL_CONNECTED) {
+        connected = target;
+        ip = staticIp ? staticIp : IPAddress(192, 168, 1, 50 + target);
+      }
+    }
+    return st;
+  }
+
+  // A local_ip of 0.0.0.0 turns DHCP back on
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress()) {
+    staticIp = local;
+    return true;
+  }
+
+  int16_t scanNetworks(bool async = false) {
+    scans++;
+    scanning = true;
+    scanAt = millis();
+    found.clear();
+    for (const AccessPoint &ap : aps)
+      if (available && ap.on) found.push_back(ap);
+    if (!async) delay(scanMs);
+    return async ? WIFI_SCAN_RUNNING : found.size();
+  }
+  int16_t scanComplete() {
+    if (!scanning) return WIFI_SCAN_FAILED;
+    return millis() - scanAt >= scanMs ? (int16_t)found.size() : WIFI_SCAN_RUNNING;
+  }
+  void scanDelete() { found.clear(); scanning = false; }
+  String SSID(uint8_t i) { return i < found.size() ? found[i].ssid : String(); }
+  int32_t RSSI(uint8_t i) { return i < found.size() ? found[i].rssi : 0; }
+  uint8_t *BSSID(uint8_t i) { return i < found.size() ? found[i].bssid : nullptr; }
+  int32_t channel(uint8_t i) { return i < found.size() ? found[i].channel : 0; }
+
+  // The link in use
+  String SSID() { return st == WL_CONNECTED ? aps[connected].ssid : String(); }
+  uint8_t *BSSID() { return st == WL_CONNECTED ? aps[connected].bssid : nullptr; }
+  int32_t channel() { return st == WL_CONNECTED ? aps[connected].channel : 0; }
+  IPAddress localIP() { return st == WL_CONNECTED ? ip : IPAddress(); }
+  IPAddress gatewayIP() { return st == WL_CONNECTED ? IPAddress(192, 168, 1, 1) : IPAddress(); }
+  IPAddress subnetMask() { return st == WL_CONNECTED ? IPAddress(255, 255, 255, 0) : IPAddress(); }
+  IPAddress dnsIP(uint8_t = 0) { return gatewayIP(); }
+
+  // Dotted quads parse; any other name resolves to host::dnsAnswer, if set
+  int hostByName(const char *name, IPAddress &ip) {
+    if (ip.fromString(name)) return 1;
+    return host::dnsAnswer != "" && ip.fromString(host::dnsAnswer.c_str());
+  }
+
+  // Host only
+  bool available = true;   // all APs at once, for "wifi on|off" in the sim
+  std::vector<AccessPoint> aps = { { "home", "", { 0x02, 0, 0, 0, 0, 1 }, 6, -55, true } };
+  unsigned long scanMs = 2000, channelScanMs = 120, assocMs = 300, dhcpMs = 1200;
+  uint32_t begins = 0, scans = 0, dhcps = 0;
+  void drop() { st = WL_CONNECTION_LOST; connecting = false; }
+
+private:
+  int target = -1, connected = -1;
+  unsigned long beganAt = 0, doneMs = 0, scanAt = 0;
+  bool connecting = false, scanning = false;
+  wl_status_t result = WL_IDLE_STATUS;
+  wl_status_t st = WL_IDLE_STATUS;
+  IPAddress staticIp, ip;
+  std::vector<AccessPoint> found;
+};
+
+#define WIFI_STA 1
+
+extern WiFiClass WiFi;
+
+#endif
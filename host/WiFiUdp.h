@@ -0,0 +1,81 @@
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+// Real non-blocking UDP sockets, so protocol code can be exercised against
+// stand-in servers on loopback. Destination ports can be remapped, which
+// lets a test server on an unprivileged port answer for port 123.
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace host { extern uint16_t udpRemapFrom, udpRemapTo; }
+
+class WiFiUDP {
+public:
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port) {
+    stop();
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return 0;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_ANY);
+    a.sin_port = htons(port);
+    if (bind(fd, (sockaddr *)&a, sizeof(a)) < 0) { stop(); return 0; }
+    return 1;
+  }
+  void stop() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+
+  int beginPacket(IPAddress ip, uint16_t port) {
+    if (port == host::udpRemapFrom && host::udpRemapTo) port = host::udpRemapTo;
+    dest = {};
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = (uint32_t)ip;
+    dest.sin_port = htons(port);
+    out.clear();
+    return fd >= 0;
+  }
+  size_t write(uint8_t b) { out.push_back(b); return 1; }
+  size_t write(const uint8_t *buf, size_t n) { out.insert(out.end(), buf, buf + n); return n; }
+  int endPacket() {
+    return fd >= 0 && sendto(fd, out.data(), out.size(), 0, (sockaddr *)&dest, sizeof(dest)) == (ssize_t)out.size();
+  }
+
+  // Size of the next datagram, 0 if none has arrived
+  int parsePacket() {
+    if (fd < 0) return 0;
+    in.resize(1500);
+    ssize_t n = recv(fd, in.data(), in.size(), MSG_DONTWAIT);
+    in.resize(n > 0 ? n : 0);
+    inPos = 0;
+    return in.size();
+  }
+  int available() { return in.size() - inPos; }
+  int read() { return inPos < in.size() ? in[inPos++] : -1; }
+  int read(uint8_t *buf, size_t n) {
+    n = std::min(n, in.size() - inPos);
+    memcpy(buf, in.data() + inPos, n);
+    inPos += n;
+    return n;
+  }
+  void flush() { inPos = in.size(); }
+
+private:
+  int fd = -1;
+  sockaddr_in dest = {};
+  std::vector<uint8_t> out, in;
+  size_t inPos = 0;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+// Counts what would go over I2C; the bytes themselves go nowhere.
+class TwoWire {
+public:
+  void begin(int sda = -1, int scl = -1, uint32_t freq = 0) {}
+  void setClock(uint32_t hz) { clock = hz; }
+  void beginTransmission(uint8_t) { bytes++; }
+  size_t write(uint8_t) { bytes++; return 1; }
+  size_t write(const uint8_t *, size_t n) { bytes += n; return n; }
+  uint8_t endTransmission(bool = true) { transactions++; return 0; }
+  uint64_t bytes = 0, transactions = 0;
+  uint32_t clock = 100000;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,159 @@
+// Checks the second-core flush path with real threads and a slow bus.
+//
+//   g++ -std=c++17 -O2 -pthread -I host -I Play_Box -o async_flush host/async_flush.cpp host/host.cpp
+//   ./async_flush [--frames N] [--compute US] [--us-per-byte US] [--full]
+//
+// 1. FlushPipe stress: one thread presents numbered frames, another takes
+//    them as fast as it can. Every frame taken must be whole (no torn slots)
+//    and newer than the last, and taken + dropped == presented.
+// 2. Jump, Jump Scroll and Shooting, stepped back to back with --compute us of busy work
+//    per frame standing in for the device's update and draw. Each game runs
+//    with display() flushing inline and then with beginAsync(). The bus
+//    spins --us-per-byte (25 ~ 400 kHz I2C) for each wire byte. --full
+//    invalidates every frame, so each flush sends all 512 bytes. The panel
+//    must match the framebuffer after sync().
+
+#include <Arduino.h>
+#include <thread>
+#include <Fonts/FreeSans9pt7b.h>
+#include "CountingBus.h"
+#include "PlayDisplay.h"
+
+PlayDisplay display(128, 32, &Wire, -1);
+
+#include "Buttons.h"
+#include "JumpGame.h"
+#include "ShootingGame.h"
+
+namespace {
+
+double nowUs() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+void spin(double us) {
+  double end = nowUs() + us;
+  while (nowUs() < end) {}
+}
+
+class SlowBus : public CountingBus {
+public:
+  double usPerByte = 25;
+  void command(const uint8_t *cmds, uint8_t n) override {
+    uint32_t before = bytesSent;
+    CountingBus::command(cmds, n);
+    spin((bytesSent - before) * usPerByte);
+  }
+  void data(const uint8_t *bytes, uint16_t n) override {
+    uint32_t before = bytesSent;
+    CountingBus::data(bytes, n);
+    spin((bytesSent - before) * usPerByte);
+  }
+};
+
+bool pipeStress(uint32_t frames) {
+  static FlushPipe pipe;
+  std::atomic<bool> done{false};
+  uint32_t taken = 0, torn = 0, backwards = 0;
+  std::thread consumer([&] {
+    uint32_t last = 0;
+    for (;;) {
+      bool finished = done.load();
+      const uint8_t *fb = pipe.take();
+      if (!fb) {
+        if (finished) break;
+        continue;
+      }
+      uint32_t seq;
+      memcpy(&seq, fb, 4);
+      for (int i = 4; i < FLUSH_BYTES; i++)
+        if (fb[i] != (uint8_t)seq) { torn++; break; }
+      if (seq <= last) backwards++;
+      last = seq;
+      taken++;
+    }
+  });
+  static uint8_t fb[FLUSH_BYTES];
+  for (uint32_t seq = 1; seq <= frames; seq++) {
+    memcpy(fb, &seq, 4);
+    memset(fb + 4, (uint8_t)seq, FLUSH_BYTES - 4);
+    pipe.present(fb);
+    if (seq % 3 == 0) std::this_thread::yield();  // let the consumer in mid-stream on one core too
+  }
+  done.store(true);
+  consumer.join();
+  uint32_t dropped = pipe.dropped.load();
+  bool ok = !torn && !backwards && taken + dropped == pipe.presented;
+  printf("pipe: %u presented, %u taken, %u dropped, %u torn, %u out of order: %s\n", pipe.presented, taken,
+         dropped, torn, backwards, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+bool runMode(const char *name, const Game &game, bool async, uint32_t frames, double computeUs, bool full,
+             SlowBus &bus) {
+  if (async) display.beginAsync();
+  else display.endAsync();
+  display.invalidate();
+  uint32_t presented0 = display.framesPresented(), dropped0 = display.framesDropped();
+  uint32_t flushed0 = display.framesFlushed();
+  uint32_t bytes0 = bus.bytesSent;
+
+  gameClock = 0;
+  game.init();
+  double t0 = nowUs();
+  for (uint32_t f = 0; f < frames; f++) {
+    game.update();
+    gameClock += game.stepMs;
+    host::advance(game.stepMs * 1000ULL);
+    if (game.finished()) game.init();
+    spin(computeUs);
+    if (full) display.invalidate();
+    game.render();
+  }
+  display.sync();
+  double elapsed = nowUs() - t0;
+
+  bool match = !memcmp(bus.gdram, display.getBuffer(), FLUSH_BYTES);
+  printf("  %-10s %-6s %7.1f fps  %6.1f bytes/frame", name, async ? "async" : "inline", frames * 1e6 / elapsed,
+         (bus.bytesSent - bytes0) / (double)frames);
+  if (async)
+    printf("  %u presented, %u flushed, %u dropped", display.framesPresented() - presented0,
+           display.framesFlushed() - flushed0, display.framesDropped() - dropped0);
+  printf("  panel %s\n", match ? "matches" : "DIFFERS");
+  return match;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint32_t frames = 500;
+  double computeUs = 5000;
+  bool full = false;
+  SlowBus bus;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i], *v = i + 1 < argc ? argv[i + 1] : "0";
+    if (!strcmp(a, "--frames")) frames = strtoul(v, nullptr, 10), i++;
+    else if (!strcmp(a, "--compute")) computeUs = atof(v), i++;
+    else if (!strcmp(a, "--us-per-byte")) bus.usPerByte = atof(v), i++;
+    else if (!strcmp(a, "--full")) full = true;
+    else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+  }
+  Serial.enabled = false;
+  for (int pin = 0; pin < 64; pin++) host::pinLevel[pin] = HIGH;
+
+  bool ok = pipeStress(200000);
+
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  display.setBus(&bus);
+  printf("%u frames, %.0f us compute/frame, %.1f us/byte%s\n", frames, computeUs, bus.usPerByte,
+         full ? ", full frames" : "");
+  const struct { const char *name; const Game *game; } games[] = { { "jump", &jumpGame }, { "jumpscroll", &jumpScrollGame }, { "shooting", &shootingGame } };
+  for (auto &g : games) {
+    randomSeed(7);
+    ok &= runMode(g.name, *g.game, false, frames, computeUs, full, bus);
+    randomSeed(7);
+    ok &= runMode(g.name, *g.game, true, frames, computeUs, full, bus);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+// Microbenchmarks for the game and screen kernels, built against the real
+// sketch like host/sim.cpp. Each kernel is warmed up, then timed over
+// --reps repetitions of a batch sized to about --rep-ms; the median ns/op
+// is the figure of merit, the min and the median absolute deviation (MAD)
+// show how noisy it was. All randomness is seeded, so every run does the
+// same work.
+//
+//   g++ -std=c++17 -O2 -pthread -I host -I Play_Box -o bench host/bench.cpp host/host.cpp
+//
+//   ./bench --out base.tsv                    # save a baseline
+//   ./bench --baseline base.tsv --out new.tsv # later: compare against it
+//   ./bench --filter draw. --reps 31
+//
+// Results are TSV: kernel, median_ns, min_ns, mad_ns, reps, ops_per_rep.
+// With --baseline, a kernel whose median is more than --threshold percent
+// (default 10) and more than 3 MADs slower than the baseline is reported
+// as REGRESSED and the exit status is 1.
+//
+// Kernels:
+//   snake.move              moveSnake() round a fixed loop, no food
+//   snake.food/L            generateFood() with L cells under the snake
+//   snake.plan/L            botSteer() for an L-cell snake coiled row by row
+//                           from the top left, food in the far corner;
+//                           snake.plan1/L is the same on the 1 px board
+//   shoot.move/.collide     ShootEngine move() / collide() (moveObjects and
+//                           checkCollisions of the old shooting_game.c) on
+//                           full pools; both include the scene restore that
+//                           shoot.restore times alone. shoot64.* is the same
+//                           with 64-entry pools.
+//   jump.step               jumpUpdate() with a bot that clears every obstacle
+//   draw.*                  the draw functions, including their flush into
+//                           an in-memory panel; draw.snakeStep includes the
+//                           moveSnake() that makes it draw something, and
+//                           draw.menu is one cursor step (draw.menu.full a
+//                           whole repaint); draw.trend adds a sample to the
+//                           2 h sparkline, draw.trend.full redraws it
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "CountingBus.h"
+#include "../Play_Box/Play_Box.ino"
+#include "JumpBot.h"
+
+namespace {
+
+double nowNs() {
+  using namespace std::chrono;
+  return duration<double, std::nano>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Kernel {
+  std::string name;
+  std::function<void()> setup;
+  std::function<void()> op;
+};
+
+struct Result {
+  std::string name;
+  double median, min, mad;
+  int reps;
+  long ops;
+};
+
+int reps = 15;
+double repMs = 5;
+
+double median(std::vector<double> v) {
+  std::sort(v.begin(), v.end());
+  size_t n = v.size();
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+Result run(const Kernel &k) {
+  k.setup();
+
+  // Warm up for a few batches' worth of time and size the batch from it
+  long ops = 0;
+  double t0 = nowNs(), warm = repMs * 3e6;
+  while (nowNs() - t0 < warm) {
+    k.op();
+    ops++;
+  }
+  long batch = std::max(1L, (long)(ops * repMs * 1e6 / (nowNs() - t0)));
+
+  std::vector<double> perOp;
+  for (int r = 0; r < reps; r++) {
+    double s = nowNs();
+    for (long i = 0; i < batch; i++) k.op();
+    perOp.push_back((nowNs() - s) / batch);
+  }
+
+  Result res = { k.name, median(perOp), *std::min_element(perOp.begin(), perOp.end()), 0, reps, batch };
+  std::vector<double> dev;
+  for (double v : perOp) dev.push_back(fabs(v - res.median));
+  res.mad = median(dev);
+  return res;
+}
+
+// --- Snake ---
+
+// Steer clockwise round the rectangle x 2..50, y 4..10; startSnakeGame()
+// leaves the head at (5, 4) heading right, which is on it
+void snakeSteer() {
+  int head = snakeCell(0);
+  int x = head % GRID_WIDTH, y = head / GRID_WIDTH;
+  if (dirX == 1 && x == 50) { dirX = 0; dirY = 1; }
+  else if (dirY == 1 && y == 10) { dirX = -1; dirY = 0; }
+  else if (dirX == -1 && x == 2) { dirX = 0; dirY = -1; }
+  else if (dirY == -1 && y == 4) { dirX = 1; dirY = 0; }
+}
+
+void snakeSetup() {
+  gameSeed(1);
+  snakeBlock = BLOCK_SIZE;
+  startSnakeGame();
+  foodX = foodY = -1;  // never eats, so the length stays put
+}
+
+void snakeMoveOp() {
+  snakeSteer();
+  moveSnake();
+}
+
+// Snake of `len` cells as far as generateFood() is concerned: only the
+// free-cell set matters to it
+void snakeFoodSetup(int len) {
+  snakeSetup();
+  for (int c = 0; freeCount > GRID_WIDTH * GRID_HEIGHT - len; c++)
+    if (!cellTaken(c)) takeCell(c);
+}
+
+// Snake of `len` cells laid boustrophedon from the top left, head last.
+// From two rows on the tail is walled in behind the coil, so the planner
+// also runs its detour search: the slow case. Food goes in the bottom right.
+void snakePlanSetup(int block, int len) {
+  gameSeed(1);
+  snakeBlock = block;
+  startSnakeGame();
+  for (int i = 0; i < snakeLength; i++) releaseCell(snakeCell(i));
+  snakeLength = len;
+  snakeHead = len - 1;
+  for (int i = 0; i < len; i++) {
+    int y = i / GRID_WIDTH, x = y & 1 ? GRID_WIDTH - 1 - i % GRID_WIDTH : i % GRID_WIDTH;
+    snakeBody[i] = y * GRID_WIDTH + x;
+    takeCell(snakeBody[i]);
+  }
+  dirX = (len - 1) / GRID_WIDTH & 1 ? -1 : 1;
+  dirY = 0;
+  foodX = GRID_WIDTH - 1;
+  foodY = GRID_HEIGHT - 1;
+}
+
+// --- Shooting ---
+
+template <int B, int E, int EB>
+struct ShootBench {
+  ShootEngine<B, E, EB> eng, scene;
+
+  void setup() {
+    gameSeed(7);
+    scene.reset(0);
+    while (scene.addBullet(FX(gameRandom(0, 128)), FX(gameRandom(SHOOT_TOP, 32))) >= 0) {}
+    while (scene.addEnemy(FX(gameRandom(0, 124)), FX(gameRandom(SHOOT_TOP, 28)), 'o') >= 0) {}
+    while (scene.addEnemyShot(FX(gameRandom(0, 128)), FX(gameRandom(SHOOT_TOP, 32))) >= 0) {}
+    scene.move(GAME_STEP_MS);  // so collide() has a step's motion to sweep
+    eng = scene;
+  }
+};
+
+ShootBench<3, 5, 5> shootBench;
+ShootBench<64, 64, 64> shoot64Bench;
+
+// --- Jump ---
+
+void jumpSetup() {
+  jumpInit();
+  buttonsFed = true;  // the bot below holds the button, not the pins
+}
+
+uint32_t jumpDeaths = 0;
+
+void jumpOp() {
+  jumpBotPress();
+  jumpUpdate();
+  gameClock += GAME_STEP_MS;
+  if (jumpDead) {
+    jumpDeaths++;
+    jumpInit();
+  }
+}
+
+// --- Trend ---
+
+int trendSample = 0;
+
+void trendSetup() {
+  tempClear();
+  for (int i = 0; i < 300; i++) tempAddSample(200 + i % 20);
+  trendRange = TREND_2H;
+  trendInvalidate();
+  drawTrend();
+}
+
+std::vector<Kernel> kernels() {
+  std::vector<Kernel> ks;
+  ks.push_back({ "snake.move", snakeSetup, snakeMoveOp });
+  for (int len : { 3, 100, 400, 790 })
+    ks.push_back({ "snake.food/" + std::to_string(len), [len] { snakeFoodSetup(len); }, [] { generateFood(); } });
+
+  for (int len : { 3, 50, 200, 400, 700 })
+    ks.push_back({ "snake.plan/" + std::to_string(len), [len] { snakePlanSetup(BLOCK_SIZE, len); }, botSteer });
+  for (int len : { 3, 400, 1600, 3000 })
+    ks.push_back({ "snake.plan1/" + std::to_string(len), [len] { snakePlanSetup(1, len); }, botSteer });
+  ks.push_back({ "shoot.restore", [] { shootBench.setup(); }, [] { shootBench.eng = shootBench.scene; } });
+  ks.push_back({ "shoot.move", [] { shootBench.setup(); },
+                 [] { shootBench.eng = shootBench.scene; shootBench.eng.move(GAME_STEP_MS); } });
+  ks.push_back({ "shoot.collide", [] { shootBench.setup(); },
+                 [] { shootBench.eng = shootBench.scene; shootBench.eng.collide(); } });
+  ks.push_back({ "shoot64.restore", [] { shoot64Bench.setup(); }, [] { shoot64Bench.eng = shoot64Bench.scene; } });
+  ks.push_back({ "shoot64.move", [] { shoot64Bench.setup(); },
+                 [] { shoot64Bench.eng = shoot64Bench.scene; shoot64Bench.eng.move(GAME_STEP_MS); } });
+  ks.push_back({ "shoot64.collide", [] { shoot64Bench.setup(); },
+                 [] { shoot64Bench.eng = shoot64Bench.scene; shoot64Bench.eng.collide(); } });
+
+  ks.push_back({ "jump.step", jumpSetup, jumpOp });
+
+  ks.push_back({ "draw.snakeGame", snakeSetup, drawSnakeGame });
+  ks.push_back({ "draw.snakeStep", snakeSetup, [] { snakeMoveOp(); drawSnakeStep(); } });
+  ks.push_back({ "draw.snakeBorders", snakeSetup, drawSnakeBorders });
+  ks.push_back({ "draw.snakeScore", snakeSetup, drawSnakeScore });
+  ks.push_back({ "draw.jumpScene", jumpSetup, drawJumpScene });
+  ks.push_back({ "draw.shooting", [] { shootBench.setup(); }, [] { shootBench.eng.draw(display); display.display(); } });
+  ks.push_back({ "draw.clock", [] { clockFaceInvalidate(); drawClock(); },
+                 [] { host::advance(1000000); drawClock(); } });
+  ks.push_back({ "draw.clock.full", [] {}, [] { clockFaceInvalidate(); display.clearDisplay(); drawClock(); } });
+  ks.push_back({ "draw.menu", [] { menuOpen(mainMenu); drawMenu(); }, [] { menuMove(1); drawMenu(); } });
+  ks.push_back({ "draw.menu.full", [] { menuOpen(mainMenu); }, [] { menuInvalidate(); drawMenu(); } });
+  ks.push_back({ "draw.trend", trendSetup, [] { tempAddSample(200 + trendSample++ % 20); drawTrend(); } });
+  ks.push_back({ "draw.trend.full", trendSetup, [] { trendInvalidate(); drawTrend(); } });
+  return ks;
+}
+
+bool writeResults(const char *path, const std::vector<Result> &rs) {
+  FILE *f = fopen(path, "w");
+  if (!f) { perror(path); return false; }
+  fprintf(f, "# kernel\tmedian_ns\tmin_ns\tmad_ns\treps\tops_per_rep\n");
+  for (const Result &r : rs)
+    fprintf(f, "%s\t%.2f\t%.2f\t%.2f\t%d\t%ld\n", r.name.c_str(), r.median, r.min, r.mad, r.reps, r.ops);
+  fclose(f);
+  return true;
+}
+
+bool readResults(const char *path, std::map<std::string, Result> &out) {
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); return false; }
+  char line[256], name[128];
+  Result r;
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') continue;
+    if (sscanf(line, "%127s %lf %lf %lf %d %ld", name, &r.median, &r.min, &r.mad, &r.reps, &r.ops) == 6) {
+      r.name = name;
+      out[name] = r;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+int usage() {
+  fprintf(stderr, "usage: bench [--out FILE] [--baseline FILE] [--threshold PCT] [--reps N] [--rep-ms MS]\n"
+                  "             [--filter SUBSTR]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *outPath = "bench_results.tsv", *basePath = nullptr, *filter = "";
+  double threshold = 10;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--out") && v) outPath = argv[++i];
+    else if (!strcmp(a, "--baseline") && v) basePath = argv[++i];
+    else if (!strcmp(a, "--threshold") && v) threshold = atof(argv[++i]);
+    else if (!strcmp(a, "--reps") && v) reps = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--rep-ms") && v) repMs = std::max(0.1, atof(argv[++i]));
+    else if (!strcmp(a, "--filter") && v) filter = argv[++i];
+    else return usage();
+  }
+
+  std::map<std::string, Result> base;
+  if (basePath && !readResults(basePath, base)) return 1;
+
+  Serial.enabled = false;
+  for (int pin = 0; pin < 64; pin++) host::pinLevel[pin] = HIGH;
+  CountingBus bus;
+  setup();
+  display.endAsync();
+  display.setBus(&bus);
+
+  std::vector<Result> results;
+  int regressed = 0;
+  printf("%-20s %10s %10s %8s", "kernel", "median ns", "min ns", "mad");
+  if (basePath) printf(" %10s %8s", "baseline", "change");
+  printf("\n");
+  for (const Kernel &k : kernels()) {
+    if (!strstr(k.name.c_str(), filter)) continue;
+    Result r = run(k);
+    buttonsFed = false;
+    results.push_back(r);
+    printf("%-20s %10.1f %10.1f %8.1f", r.name.c_str(), r.median, r.min, r.mad);
+    auto it = base.find(r.name);
+    if (it != base.end()) {
+      const Result &b = it->second;
+      double change = (r.median - b.median) / b.median * 100;
+      double noise = 3 * std::max(r.mad, b.mad);
+      const char *verdict = "";
+      if (change > threshold && r.median - b.median > noise) verdict = "  REGRESSED", regressed++;
+      else if (change < -threshold && b.median - r.median > noise) verdict = "  improved";
+      printf(" %10.1f %+7.1f%%%s", b.median, change, verdict);
+    }
+    printf("\n");
+  }
+  if (jumpDeaths) printf("warning: jump.step bot died %u times\n", jumpDeaths);
+
+  if (!writeResults(outPath, results)) return 1;
+  printf("results in %s\n", outPath);
+  if (regressed) printf("%d kernel(s) regressed against %s\n", regressed, basePath);
+  return regressed ? 1 : 0;
+}
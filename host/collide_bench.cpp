@@ -0,0 +1,121 @@
+// Shooting collision pass: all-pairs loops (as in checkCollisions()) vs
+// column occupancy masks, at N bullets, N enemies and N enemy bullets.
+// Both must find the same hits, in these scenes and in 200 more seeds per
+// N; the exit status is 1 if they ever don't.
+//
+//   g++ -std=c++17 -O2 -o collide_bench host/collide_bench.cpp && ./collide_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "../Play_Box/ColumnCollide.h"
+
+struct Obj { int x, y; bool active; };
+
+struct Scene {
+  std::vector<Obj> bullets, enemies, eBullets;
+  int playerX = 4, playerY = 14;
+};
+
+static Scene makeScene(int n, unsigned seed) {
+  srand(seed);
+  Scene s;
+  for (int i = 0; i < n; i++) {
+    s.bullets.push_back({ rand() % 128, 10 + rand() % 22, true });
+    s.enemies.push_back({ rand() % 124, 10 + rand() % 18, true });
+    s.eBullets.push_back({ rand() % 128, 10 + rand() % 22, true });
+  }
+  return s;
+}
+
+// Same tests and order as checkCollisions() in shooting_game.c
+static int nested(Scene &s) {
+  int hits = 0;
+  for (auto &b : s.bullets) {
+    if (!b.active) continue;
+    for (auto &e : s.enemies)
+      if (b.active && e.active && b.x >= e.x && b.x <= e.x + 4 && b.y >= e.y && b.y <= e.y + 4)
+        { b.active = false; e.active = false; hits++; }
+    for (auto &eb : s.eBullets)
+      if (b.active && eb.active && abs(b.x - eb.x) <= 1 && abs(b.y - eb.y) <= 1)
+        { b.active = false; eb.active = false; hits++; }
+  }
+  for (auto &eb : s.eBullets)
+    if (eb.active && eb.x <= s.playerX + 3 && eb.y >= s.playerY && eb.y <= s.playerY + 4)
+      eb.active = false, hits++;
+  for (auto &e : s.enemies)
+    if (e.active && e.x <= s.playerX + 3 && e.y <= s.playerY + 4 && e.y + 4 >= s.playerY)
+      e.active = false, hits++;
+  return hits;
+}
+
+static CollideLayer<1000> enemyLayer, eBulletLayer;
+
+static int masked(Scene &s) {
+  int hits = 0;
+  enemyLayer.clear();
+  for (size_t i = 0; i < s.enemies.size(); i++)
+    if (s.enemies[i].active) enemyLayer.add(i, s.enemies[i].x, s.enemies[i].y, 5, 5);
+  eBulletLayer.clear();
+  for (size_t i = 0; i < s.eBullets.size(); i++)
+    if (s.eBullets[i].active) eBulletLayer.add(i, s.eBullets[i].x - 1, s.eBullets[i].y - 1, 3, 3);
+
+  auto enemyAlive = [&](uint16_t id) { return s.enemies[id].active; };
+  auto eBulletAlive = [&](uint16_t id) { return s.eBullets[id].active; };
+
+  for (auto &b : s.bullets) {
+    if (!b.active) continue;
+    int e = enemyLayer.hit(b.x, b.y, 1, 1, enemyAlive);
+    if (e >= 0) { b.active = false; s.enemies[e].active = false; hits++; continue; }
+    int eb = eBulletLayer.hit(b.x, b.y, 1, 1, eBulletAlive);
+    if (eb >= 0) { b.active = false; s.eBullets[eb].active = false; hits++; }
+  }
+  // The player's hitbox reaches from the left edge, like the original test
+  int id;
+  while ((id = eBulletLayer.hit(0, s.playerY + 1, s.playerX + 3, 3, eBulletAlive)) >= 0)
+    s.eBullets[id].active = false, hits++;
+  while ((id = enemyLayer.hit(0, s.playerY, s.playerX + 4, 5, enemyAlive)) >= 0)
+    s.enemies[id].active = false, hits++;
+  return hits;
+}
+
+template <typename F>
+static double timeIt(int n, F pass, int &hits) {
+  Scene base = makeScene(n, 42);
+  int reps = n <= 10 ? 200000 : n <= 100 ? 5000 : 50;
+  using clk = std::chrono::steady_clock;
+  double best = 1e30;
+  for (int round = 0; round < 5; round++) {
+    double total = 0;
+    for (int r = 0; r < reps; r++) {
+      Scene s = base;
+      auto t0 = clk::now();
+      hits = pass(s);
+      total += std::chrono::duration<double, std::nano>(clk::now() - t0).count();
+    }
+    if (total / reps < best) best = total / reps;
+  }
+  return best;
+}
+
+int main() {
+  int failures = 0;
+  printf("%6s %14s %14s %8s %12s\n", "N", "nested ns", "masks ns", "speedup", "hits n/m");
+  for (int n : { 10, 100, 1000 }) {
+    int h1 = 0, h2 = 0;
+    double a = timeIt(n, nested, h1);
+    double b = timeIt(n, masked, h2);
+    printf("%6d %14.0f %14.0f %7.1fx %6d/%-6d\n", n, a, b, a / b, h1, h2);
+    failures += h1 != h2;
+    for (unsigned seed = 1; seed <= 200; seed++) {
+      Scene s1 = makeScene(n, seed), s2 = s1;
+      if (nested(s1) != masked(s2)) {
+        printf("N=%d seed %u: hit counts differ\n", n, seed);
+        failures++;
+      }
+    }
+  }
+  if (failures) printf("%d mismatch(es)\n", failures);
+  return failures ? 1 : 0;
+}
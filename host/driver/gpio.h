@@ -0,0 +1,24 @@
+#ifndef HOST_DRIVER_GPIO_H
+#define HOST_DRIVER_GPIO_H
+
+#include "../esp_sleep.h"
+
+typedef int gpio_num_t;
+
+enum gpio_int_type_t {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+  GPIO_INTR_LOW_LEVEL,
+  GPIO_INTR_HIGH_LEVEL,
+};
+
+inline esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+  host::wakeLevel[pin & 63] = 1 + (type == GPIO_INTR_LOW_LEVEL ? LOW : HIGH);
+  return 0;
+}
+inline esp_err_t gpio_wakeup_disable(gpio_num_t pin) { host::wakeLevel[pin & 63] = 0; return 0; }
+inline esp_err_t gpio_set_intr_type(gpio_num_t, gpio_int_type_t) { return 0; }
+
+#endif
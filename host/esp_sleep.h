@@ -0,0 +1,35 @@
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+
+// Light sleep on the virtual clock: esp_light_sleep_start() skips ahead to
+// the timer or to the first external event that pulls a wake pin to its
+// level, whichever comes first.
+
+#include "Arduino.h"
+
+typedef int esp_err_t;
+
+enum esp_sleep_source_t {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7,
+};
+
+namespace host {
+extern uint64_t sleepTimerUs;
+extern uint64_t sleptUs;          // total time spent in light sleep
+extern uint32_t sleeps;
+extern bool gpioWakeEnabled;
+extern uint8_t wakeLevel[64];     // level + 1, 0 = not a wake source
+extern esp_sleep_source_t wakeCause;
+extern uint64_t (*nextEventUs)(); // when the simulator next changes something
+extern void (*applyEvents)();
+void lightSleep();
+}
+
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) { host::sleepTimerUs = us; return 0; }
+inline esp_err_t esp_sleep_enable_gpio_wakeup() { host::gpioWakeEnabled = true; return 0; }
+inline esp_err_t esp_light_sleep_start() { host::lightSleep(); return 0; }
+inline esp_sleep_source_t esp_sleep_get_wakeup_cause() { return host::wakeCause; }
+
+#endif
@@ -0,0 +1,51 @@
+// Host check for PageFlusher: replays Jump game frames into a raw SSD1306
+// page buffer and compares full-frame pushes with dirty-window pushes.
+//
+//   g++ -std=c++17 -O2 -o flush_bytes host/flush_bytes.cpp && ./flush_bytes
+
+#include <stdio.h>
+#include "CountingBus.h"
+
+static uint8_t fb[FLUSH_BYTES];
+
+static void fillRect(int x, int y, int w, int h) {
+  for (int i = x; i < x + w; i++)
+    for (int j = y; j < y + h; j++)
+      if (i >= 0 && i < FLUSH_WIDTH && j >= 0 && j < FLUSH_PAGES * 8)
+        fb[(j / 8) * FLUSH_WIDTH + i] |= 1 << (j & 7);
+}
+
+int main() {
+  CountingBus fullBus, dirtyBus;
+  PageFlusher full, dirty;
+  full.bus = &fullBus;
+  dirty.bus = &dirtyBus;
+
+  int playerY = 20, velocity = 0, obstacleX = 128;
+  const int frames = 1000;
+  for (int f = 0; f < frames; f++) {
+    if (f % 40 == 0 && playerY == 20) velocity = -6;
+    playerY += velocity;
+    if (velocity || playerY < 20) velocity++;
+    if (playerY >= 20) { playerY = 20; velocity = 0; }
+    obstacleX -= 3;
+    if (obstacleX < -5) obstacleX = 128;
+
+    memset(fb, 0, sizeof(fb));
+    fillRect(0, 30, 128, 1);
+    fillRect(5, playerY, 5, 10);
+    fillRect(obstacleX, 22, 5, 8);
+
+    full.invalidate();
+    full.flush(fb);
+    dirty.flush(fb);
+    if (memcmp(dirtyBus.gdram, fb, FLUSH_BYTES) != 0) {
+      printf("frame %d: controller RAM mismatch\n", f);
+      return 1;
+    }
+  }
+
+  printf("full  : %7.1f bytes/frame\n", fullBus.bytesSent / (double)frames);
+  printf("dirty : %7.1f bytes/frame\n", dirtyBus.bytesSent / (double)frames);
+  return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t notified = 0;
+};
+
+namespace host { inline thread_local HostTask *currentTask = nullptr; }
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *, uint32_t, void *arg,
+                                          UBaseType_t, TaskHandle_t *out, BaseType_t) {
+  HostTask *t = new HostTask;
+  if (out) *out = t;
+  std::thread([t, fn, arg] {
+    host::currentTask = t;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+inline void xTaskNotifyGive(TaskHandle_t t) {
+  {
+    std::lock_guard<std::mutex> lock(t->m);
+    t->notified++;
+  }
+  t->cv.notify_one();
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  HostTask *t = host::currentTask;
+  std::unique_lock<std::mutex> lock(t->m);
+  auto ready = [t] { return t->notified > 0; };
+  if (ticks == portMAX_DELAY) t->cv.wait(lock, ready);
+  else t->cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+  uint32_t n = t->notified;
+  if (n) t->notified = clear ? 0 : n - 1;
+  return n;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+#endif
@@ -0,0 +1,85 @@
+// Globals and clock for the host stand-ins in this directory.
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "WiFi.h"
+#include "Preferences.h"
+#include "esp_sleep.h"
+
+namespace host {
+uint64_t nowUs = 0;
+uint64_t delayedUs = 0;
+uint8_t pinLevel[64];
+void (*isr[64])();
+uint8_t isrMode[64];
+unsigned long epochBase = 1767225600UL;  // 2026-01-01 00:00 UTC
+unsigned long ntpSyncMs = 40;
+unsigned long bleInitMs = 450;
+float temperatureC = 24.5f;
+static uint32_t rngState = 1;
+
+void setPin(uint8_t pin, uint8_t level) {
+  pin &= 63;
+  uint8_t old = pinLevel[pin];
+  pinLevel[pin] = level;
+  if (old == level || !isr[pin]) return;
+  uint8_t mode = isrMode[pin];
+  if (mode == CHANGE || (mode == FALLING && !level) || (mode == RISING && level)) isr[pin]();
+}
+
+void (*tick)() = nullptr;
+String dnsAnswer;
+uint16_t udpRemapFrom = 0, udpRemapTo = 0;
+
+void advance(uint64_t us) {
+  nowUs += us;
+  if (tick) tick();
+}
+
+uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+void seedRandom(uint32_t s) { rngState = s ? s : 1; }
+
+uint64_t sleepTimerUs = 0, sleptUs = 0;
+uint32_t sleeps = 0;
+bool gpioWakeEnabled = false;
+uint8_t wakeLevel[64] = { 0 };
+esp_sleep_source_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+uint64_t (*nextEventUs)() = nullptr;
+void (*applyEvents)() = nullptr;
+
+static bool wakePinActive() {
+  if (!gpioWakeEnabled) return false;
+  for (int pin = 0; pin < 64; pin++)
+    if (wakeLevel[pin] && pinLevel[pin] == wakeLevel[pin] - 1) return true;
+  return false;
+}
+
+void lightSleep() {
+  uint64_t start = nowUs, end = nowUs + sleepTimerUs;
+  sleeps++;
+  wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+  while (!wakePinActive()) {
+    uint64_t next = nextEventUs ? nextEventUs() : end;
+    if (next >= end) { nowUs = end; break; }
+    if (next > nowUs) nowUs = next;
+    if (tick) tick();
+    if (applyEvents) applyEvents();
+  }
+  if (wakePinActive()) wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+  sleptUs += nowUs - start;
+  gpioWakeEnabled = false;
+  sleepTimerUs = 0;
+}
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+WiFiClass WiFi;
+uint32_t Preferences::writes = 0;
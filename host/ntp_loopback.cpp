@@ -0,0 +1,72 @@
+// Runs AsyncNtp against the loopback NTP stand-in for hours of virtual time
+// and reports how well the local clock tracks true time between syncs.
+//
+//   g++ -std=c++17 -O2 -I host -I Play_Box -o ntp_loopback host/ntp_loopback.cpp host/host.cpp
+//   ./ntp_loopback --hours 24 --delay 40 --jitter 30 --loss 20 --skew 80
+//
+// The client is polled every --poll ms (default 10), as ntpTask does.
+
+#include <Arduino.h>
+#include <chrono>
+#include "NtpServer.h"
+#include "NtpSync.h"
+
+NtpServer ntpServer;
+
+int main(int argc, char **argv) {
+  double hours = 24;
+  uint32_t pollMs = 10, seed = 1;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char *a = argv[i], *v = argv[i + 1];
+    if (!strcmp(a, "--hours")) hours = atof(v);
+    else if (!strcmp(a, "--delay")) ntpServer.delayMs = atoi(v);
+    else if (!strcmp(a, "--jitter")) ntpServer.jitterMs = atoi(v);
+    else if (!strcmp(a, "--loss")) ntpServer.lossPct = atoi(v);
+    else if (!strcmp(a, "--skew")) ntpServer.skewPpm = atoi(v);
+    else if (!strcmp(a, "--poll")) pollMs = std::max(1, atoi(v));
+    else if (!strcmp(a, "--seed")) seed = atoi(v);
+    else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+  }
+
+  uint16_t port = ntpServer.begin(seed);
+  if (!port) { perror("ntp stand-in"); return 1; }
+  host::udpRemapFrom = NTP_PORT;
+  host::udpRemapTo = port;
+  host::tick = [] { ntpServer.poll(); };
+
+  WiFiUDP udp;
+  AsyncNtp ntp(udp, "127.0.0.1");
+  ntp.begin();
+
+  uint64_t end = (uint64_t)(hours * 3600e6);
+  int64_t maxErr = 0, sumErr = 0;
+  uint64_t samples = 0;
+  double maxUpdateNs = 0;
+  uint32_t lastSyncs = 0;
+  while (host::nowUs < end) {
+    auto t0 = std::chrono::steady_clock::now();
+    bool synced = ntp.update();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    maxUpdateNs = std::max(maxUpdateNs, ns);
+    if (synced && ntp.syncs - lastSyncs == 1 && ntp.syncs > 1)
+      printf("%8.3f h  sync %3u  error %+5d ms  drift %+4d ppm  next in %6.0f s\n", host::nowUs / 3600e6,
+             ntp.syncs, ntp.lastErrorMs(), ntp.driftPpm(), ntp.intervalMs() / 1000.0);
+    lastSyncs = ntp.syncs;
+    if (ntp.isTimeSet() && host::nowUs % 1000000 < pollMs * 1000) {  // once a second
+      int64_t err = (int64_t)(ntp.unixMs() - ntpServer.trueMs());
+      maxErr = std::max(maxErr, err < 0 ? -err : err);
+      sumErr += err < 0 ? -err : err;
+      samples++;
+    }
+    host::advance(pollMs * 1000ULL);
+  }
+
+  printf("%.1f h: %u syncs, %u timeouts, %u requests (%u dropped)\n", hours, ntp.syncs, ntp.timeouts,
+         ntpServer.requests, ntpServer.dropped);
+  printf("  drift estimate %+d ppm (true %+d), interval %.0f s\n", ntp.driftPpm(), -ntpServer.skewPpm,
+         ntp.intervalMs() / 1000.0);
+  printf("  clock error vs true time: mean %.1f ms, max %lld ms\n", samples ? sumErr / (double)samples : 0.0,
+         (long long)maxErr);
+  printf("  slowest update() %.0f ns\n", maxUpdateNs);
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Decodes the phase histograms Profiler.h streams over Serial and prints
+// count, p50, p99 and max per phase. Text on the same port is skipped.
+//
+//   g++ -std=c++17 -O2 -I host -I Play_Box -o prof_decode host/prof_decode.cpp
+//   ./prof_decode capture.bin            # one table per dump
+//   ./prof_decode --total capture.bin    # all dumps merged
+//
+// Host capture: build the simulator with -DPLAYBOX_PROFILE and keep stderr,
+//   ./playbox_sim --game shooting --frames 20000 2> capture.bin
+
+#include <Arduino.h>
+#include <vector>
+#include "Profiler.h"
+
+static const char *phaseNames[] = { "input", "update", "move", "collide", "render", "flush", "tasks" };
+static_assert(sizeof(phaseNames) / sizeof(phaseNames[0]) == PROF_PHASES, "phase names out of date");
+
+struct Hist {
+  uint64_t count = 0;
+  uint32_t max = 0;
+  uint64_t n[PROF_BUCKETS] = {};
+};
+
+// Smallest value that lands in bucket b, and the bucket's width
+static void bucketRange(int b, double &lo, double &width) {
+  if (b < PROF_SUB) { lo = b; width = 1; return; }
+  int shift = b / PROF_SUB - 1;
+  lo = (double)((PROF_SUB + b % PROF_SUB) << shift);
+  width = (double)(1u << shift);
+}
+
+static double percentile(const Hist &h, double q) {
+  uint64_t total = 0;
+  for (int b = 0; b < PROF_BUCKETS; b++) total += h.n[b];
+  if (!total) return 0;
+  uint64_t want = (uint64_t)(q * total + 0.5), seen = 0;
+  if (!want) want = 1;
+  for (int b = 0; b < PROF_BUCKETS; b++) {
+    seen += h.n[b];
+    if (seen >= want) {
+      double lo, width;
+      bucketRange(b, lo, width);
+      return std::min(lo + width / 2, (double)h.max);
+    }
+  }
+  return h.max;
+}
+
+static void print(const Hist *h, unsigned mhz, double windowMs) {
+  printf("%.0f ms @ %u MHz\n", windowMs, mhz);
+  printf("  %-8s %9s %10s %10s %10s\n", "phase", "count", "p50 us", "p99 us", "max us");
+  for (int p = 0; p < PROF_PHASES; p++) {
+    if (!h[p].count) continue;
+    printf("  %-8s %9llu %10.2f %10.2f %10.2f\n", phaseNames[p], (unsigned long long)h[p].count,
+           percentile(h[p], 0.50) / mhz, percentile(h[p], 0.99) / mhz, (double)h[p].max / mhz);
+  }
+}
+
+int main(int argc, char **argv) {
+  bool total = false;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--total")) total = true;
+    else path = argv[i];
+  }
+  FILE *f = path ? fopen(path, "rb") : stdin;
+  if (!f) { perror(path); return 1; }
+  std::vector<uint8_t> in;
+  for (int c; (c = fgetc(f)) != EOF;) in.push_back(c);
+
+  Hist sum[PROF_PHASES];
+  unsigned mhz = 0;
+  double sumMs = 0;
+  int frames = 0, bad = 0;
+  size_t i = 0;
+  while (i + 10 <= in.size()) {
+    if (in[i] != 'P' || in[i + 1] != 'F' || in[i + 2] != PROF_VERSION || in[i + 3] != PROF_PHASES) { i++; continue; }
+    size_t at = i;
+    uint8_t check = 0;
+    auto byte = [&]() -> uint32_t { if (at >= in.size()) return 0; check += in[at]; return in[at++]; };
+    auto u16 = [&]() { uint32_t v = byte(); return v | byte() << 8; };
+    auto u32 = [&]() { uint32_t v = u16(); return v | u16() << 16; };
+
+    byte(); byte(); byte(); byte();
+    unsigned frameMhz = u16();
+    uint32_t windowMs = u32();
+    Hist h[PROF_PHASES];
+    bool ok = frameMhz > 0;
+    for (int p = 0; p < PROF_PHASES && ok; p++) {
+      ok = byte() == (uint32_t)p;
+      h[p].count = u32();
+      h[p].max = u32();
+      int used = byte();
+      for (int k = 0; k < used && ok; k++) {
+        uint32_t b = byte();
+        ok = b < PROF_BUCKETS;
+        if (ok) h[p].n[b] = u16();
+      }
+    }
+    if (!ok || at >= in.size() || (uint8_t)(check) != in[at]) {
+      bad++;
+      i++;
+      continue;
+    }
+    i = at + 1;
+    frames++;
+    mhz = frameMhz;
+    sumMs += windowMs;
+    if (!total) print(h, frameMhz, windowMs);
+    for (int p = 0; p < PROF_PHASES; p++) {
+      sum[p].count += h[p].count;
+      sum[p].max = std::max(sum[p].max, h[p].max);
+      for (int b = 0; b < PROF_BUCKETS; b++) sum[p].n[b] += h[p].n[b];
+    }
+  }
+
+  if (total && frames) print(sum, mhz, sumMs);
+  fprintf(stderr, "%d dumps decoded, %d bad\n", frames, bad);
+  return frames ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// Checks Jump Scroll against a model of the controller's content scroll.
+//
+//   g++ -std=c++17 -O2 -pthread -I host -I Play_Box -o scroll_check host/scroll_check.cpp host/host.cpp
+//   ./scroll_check [--frames N] [--seed N]
+//
+// A bot plays Jump Scroll. Every frame goes to the panel model in
+// CountingBus through PlayDisplay, flushed on its task as on the device
+// (scroll layers on, waits for the controller in virtual time), and, for
+// comparison, through a second PageFlusher that redraws everything that
+// moved, and to a counter of full 512-byte pushes. Both models must hold
+// exactly the frame that was drawn after every flush. The exit status is 1
+// if they ever don't, or if two content scroll commands were ever closer
+// than SSD_SCROLL_GAP_US.
+
+#include <Arduino.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include "CountingBus.h"
+#include "PlayDisplay.h"
+
+PlayDisplay display(128, 32, &Wire, -1);
+
+#include "Buttons.h"
+#include "JumpGame.h"
+#include "JumpBot.h"
+
+int main(int argc, char **argv) {
+  uint32_t frames = 20000, seed = 7;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char *a = argv[i], *v = argv[i + 1];
+    if (!strcmp(a, "--frames")) frames = strtoul(v, nullptr, 10);
+    else if (!strcmp(a, "--seed")) seed = strtoul(v, nullptr, 10);
+    else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+  }
+  Serial.enabled = false;
+
+  CountingBus scrollBus, softBus, fullBus;
+  PageFlusher soft, full;
+  soft.bus = &softBus;
+  full.bus = &fullBus;
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  display.setBus(&scrollBus);
+  display.beginAsync();
+  scrollBus.checkGapUs = SSD_SCROLL_GAP_US;
+  buttonsFed = true;   // the bot holds the button, not the pins
+
+  gameSeed(seed);
+  gameClock = 0;
+  jumpScrollGame.init();
+  uint32_t mismatches = 0, deaths = 0, worstSteps = 0;
+  uint32_t scrollBytes = 0, softBytes = 0, stepsSince = 0, windowStart = 0;
+  for (uint32_t f = 0; f < frames; f++) {
+    jumpBotPress();
+    jumpScrollGame.update();
+    gameClock += JUMP_STEP_MS;
+    if (jumpScrollGame.finished()) {
+      deaths++;
+      jumpScrollGame.init();
+    }
+
+    uint32_t scroll0 = scrollBus.bytesSent, soft0 = softBus.bytesSent;
+    scrollBus.timeUs = max(scrollBus.timeUs, gameClock * 1000);
+    jumpScrollGame.render();
+    display.sync();
+    soft.flush(display.getBuffer());
+    full.invalidate();
+    full.flush(display.getBuffer());
+    scrollBytes += scrollBus.bytesSent - scroll0;
+    softBytes += softBus.bytesSent - soft0;
+    if (memcmp(scrollBus.gdram, display.getBuffer(), FLUSH_BYTES) ||
+        memcmp(softBus.gdram, display.getBuffer(), FLUSH_BYTES)) {
+      if (!mismatches) printf("frame %u: controller RAM differs from the frame\n", f);
+      mismatches++;
+    }
+
+    // Scroll steps in each second of game time
+    stepsSince += display.lastScrollSteps();
+    if (gameClock - windowStart >= 1000) {
+      worstSteps = max(worstSteps, stepsSince);
+      stepsSince = 0;
+      windowStart = gameClock;
+    }
+  }
+
+  printf("%u frames, seed %u, %u deaths, %u content scroll steps, %u layer moves resent\n", frames, seed, deaths,
+         scrollBus.scrolls, display.scrollResends());
+  printf("full   : %7.1f bytes/frame\n", fullBus.bytesSent / (double)frames);
+  printf("diff   : %7.1f bytes/frame\n", softBytes / (double)frames);
+  printf("scroll : %7.1f bytes/frame (%.0f%% less than diff)\n", scrollBytes / (double)frames,
+         100.0 * (1 - scrollBytes / (double)softBytes));
+  printf("scroll steps: at most %u in a second; flush task slept %.1f ms/frame, %u gap violations\n", worstSteps,
+         scrollBus.waitedUs / 1000.0 / frames, scrollBus.gapViolations);
+  if (mismatches) printf("%u frame(s) differed\n", mismatches);
+  bool ok = !mismatches && !scrollBus.gapViolations;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+// Headless Play_Box: builds the real sketch against the stand-ins in this
+// directory (in-memory SSD1306, virtual clock, scripted buttons, fake
+// WiFi/NTP/Preferences) and runs it as fast as the host allows.
+//
+//   g++ -std=c++17 -O2 -pthread -I host -I Play_Box -o playbox_sim host/sim.cpp host/host.cpp
+//
+//   ./playbox_sim --game jump --frames 100000 --seed 7
+//   ./playbox_sim --game snake --script host/scripts/snake.txt --dump frames/ --every 10
+//   ./playbox_sim --loop 60000 --script host/scripts/menu.txt
+//   ./playbox_sim --loop 200000 --script host/scripts/standby.txt
+//   ./playbox_sim --loop 90000 --script host/scripts/attract.txt
+//   ./playbox_sim --game attract --frames 200000
+//   ./playbox_sim --loop 259210000 --script host/scripts/trend.txt --dump frames/
+//   ./playbox_sim --game shooting --frames 5000 --script host/scripts/shooting.txt --record shoot.rpl
+//   ./playbox_sim --replay shoot.rpl
+//
+// --game runs one game's update/render directly on fixed steps and reports
+// host CPU time per update and per render, plus I2C bytes per frame.
+// Built with -DPLAYBOX_PROFILE, the phase histograms go to stderr for
+// host/prof_decode.cpp, with a final dump at exit.
+//
+// --record saves the session as a Replay.h log (seed plus a button mask per
+// step). --replay plays one back through the game it names, for as many
+// steps as were recorded, and fails if the last frame differs from the
+// recording. Logs saved on the device (PLAYBOX_REPLAY) replay the same way.
+//
+// --loop runs setup()/loop() for the given ms of virtual time and reports
+// time spent in light sleep and the standby duty cycle.
+//
+// Script lines: "<ms> press <pin> [hold ms]", "<ms> down <pin>",
+// "<ms> up <pin>", "<ms> creds <ssid> <pass>", "<ms> wifi on|off" (the
+// access point appears/disappears), "<ms> temp <C>" (what the sensor reads
+// from then on); '#' starts a comment.
+// Times are virtual ms since the start of the run.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "CountingBus.h"
+#include "NtpServer.h"
+#include "../Play_Box/Play_Box.ino"
+
+namespace {
+
+struct ScriptEvent {
+  uint64_t atMs;
+  int pin;
+  int level;                 // -1: BLE credentials, -2: AP on/off, -3: temperature
+  std::string a, b;
+};
+
+std::vector<ScriptEvent> script;
+size_t scriptPos = 0;
+
+bool loadScript(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); return false; }
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    if (char *hash = strchr(line, '#')) *hash = 0;
+    unsigned long long at, hold = 100;
+    char verb[16], a[64] = "", b[64] = "";
+    int n = sscanf(line, "%llu %15s %63s %63s", &at, verb, a, b);
+    if (n < 3) continue;
+    if (!strcmp(verb, "press")) {
+      if (n == 4) hold = strtoull(b, nullptr, 10);
+      script.push_back({ at, atoi(a), LOW, "", "" });
+      script.push_back({ at + hold, atoi(a), HIGH, "", "" });
+    } else if (!strcmp(verb, "down")) {
+      script.push_back({ at, atoi(a), LOW, "", "" });
+    } else if (!strcmp(verb, "up")) {
+      script.push_back({ at, atoi(a), HIGH, "", "" });
+    } else if (!strcmp(verb, "creds")) {
+      script.push_back({ at, 0, -1, a, b });
+    } else if (!strcmp(verb, "wifi")) {
+      script.push_back({ at, 0, -2, a, "" });
+    } else if (!strcmp(verb, "temp")) {
+      script.push_back({ at, 0, -3, a, "" });
+    }
+  }
+  fclose(f);
+  std::stable_sort(script.begin(), script.end(),
+                   [](const ScriptEvent &x, const ScriptEvent &y) { return x.atMs < y.atMs; });
+  return true;
+}
+
+void applyScript() {
+  while (scriptPos < script.size() && script[scriptPos].atMs <= millis()) {
+    const ScriptEvent &e = script[scriptPos++];
+    if (e.level >= 0) {
+      host::setPin(e.pin, e.level);
+    } else if (e.level == -2) {
+      WiFi.available = e.a == "on";
+      if (!WiFi.available) WiFi.drop();
+    } else if (e.level == -3) {
+      host::temperatureC = atof(e.a.c_str());
+    } else {
+      BLEDevice::find("1235")->write(e.a.c_str());
+      BLEDevice::find("1236")->write(e.b.c_str());
+    }
+  }
+}
+
+// Lets light sleep skip ahead to the next scripted change
+uint64_t nextScriptUs() {
+  return scriptPos < script.size() ? script[scriptPos].atMs * 1000ULL : UINT64_MAX;
+}
+
+NtpServer ntpServer;
+
+const char *dumpDir = nullptr;
+int dumpEvery = 1;
+uint32_t dumped = 0;
+
+// What the panel shows, as a plain PBM
+void dumpFrame(const uint8_t *ram, uint32_t frame) {
+  if (!dumpDir || frame % dumpEvery) return;
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%06u.pbm", dumpDir, frame);
+  FILE *f = fopen(path, "w");
+  if (!f) { perror(path); dumpDir = nullptr; return; }
+  fprintf(f, "P1\n%d %d\n", FLUSH_WIDTH, FLUSH_PAGES * 8);
+  for (int y = 0; y < FLUSH_PAGES * 8; y++) {
+    for (int x = 0; x < FLUSH_WIDTH; x++)
+      fputc(ram[(y / 8) * FLUSH_WIDTH + x] & (1 << (y & 7)) ? '1' : '0', f);
+    fputc('\n', f);
+  }
+  fclose(f);
+  dumped++;
+}
+
+// Sim names, or the menu names that logs recorded on the device carry
+const Game *findGame(const char *name) {
+  static const struct { const char *sim, *menu; const Game *game; } all[] = {
+    { "snake", "Snake Game", &snakeGame },
+    { "snake1", "Snake 1px", &snakeFineGame },
+    { "attract", "Attract", &attractGame },
+    { "jump", "Jump Game", &jumpGame },
+    { "jumpscroll", "Jump Scroll", &jumpScrollGame },
+    { "shooting", "Shooting Game", &shootingGame },
+    { "bullethell", "Bullet Hell", &bulletHellGame },
+  };
+  for (auto &g : all)
+    if (!strcmp(name, g.sim) || !strcmp(name, g.menu)) return g.game;
+  return nullptr;
+}
+
+double nowNs() {
+  using namespace std::chrono;
+  return duration<double, std::nano>(steady_clock::now().time_since_epoch()).count();
+}
+
+int usage() {
+  fprintf(stderr, "usage: playbox_sim (--game snake|snake1|attract|jump|jumpscroll|shooting|bullethell [--frames N] | --loop MS)\n"
+                  "                   [--script FILE] [--seed N] [--record FILE] [--dump DIR [--every N]] [--quiet]\n"
+                  "       playbox_sim --replay FILE [--dump DIR [--every N]] [--quiet]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *gameName = nullptr, *scriptPath = nullptr, *recordPath = nullptr, *replayPath = nullptr;
+  unsigned long frames = 10000, loopMs = 0;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--game") && v) gameName = argv[++i];
+    else if (!strcmp(a, "--frames") && v) frames = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--loop") && v) loopMs = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--script") && v) scriptPath = argv[++i];
+    else if (!strcmp(a, "--seed") && v) seed = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(a, "--record") && v) recordPath = argv[++i];
+    else if (!strcmp(a, "--replay") && v) replayPath = argv[++i];
+    else if (!strcmp(a, "--dump") && v) dumpDir = argv[++i];
+    else if (!strcmp(a, "--every") && v) dumpEvery = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(a, "--quiet")) Serial.enabled = false;
+    else return usage();
+  }
+  if (replayPath) {
+    FILE *f = fopen(replayPath, "rb");
+    if (!f) { perror(replayPath); return 1; }
+    size_t n = fread(&replayLog, 1, sizeof(replayLog), f);
+    fclose(f);
+    if (n < offsetof(ReplayLog, run) || replayLog.magic != REPLAY_MAGIC || replayBytes() != n) {
+      fprintf(stderr, "%s: not a replay log\n", replayPath);
+      return 1;
+    }
+    gameName = replayLog.game;
+    frames = replayLog.steps;
+  }
+  if (!gameName == !loopMs || (recordPath && replayPath)) return usage();
+  if (scriptPath && !loadScript(scriptPath)) return 1;
+
+  for (int pin = 0; pin < 64; pin++) host::pinLevel[pin] = HIGH;  // pull-ups
+  randomSeed(seed);
+
+  // pool.ntp.org is the loopback stand-in
+  if (!host::udpRemapTo) {
+    host::udpRemapFrom = NTP_PORT;
+    host::udpRemapTo = ntpServer.begin(seed);
+    host::dnsAnswer = "127.0.0.1";
+    // The script too, so presses reach a game running inside loop()
+    host::tick = [] { ntpServer.poll(); applyScript(); };
+  }
+  host::nextEventUs = nextScriptUs;
+  host::applyEvents = applyScript;
+
+  CountingBus bus;
+  setup();
+  display.endAsync();  // flush inline so frames can be counted and dumped
+  display.setBus(&bus);
+
+  if (loopMs) {
+    uint32_t frame = 0;
+    uint64_t end = host::nowUs + loopMs * 1000ULL;
+    double t0 = nowNs();
+    while (host::nowUs < end) {
+      applyScript();
+      uint32_t before = bus.transactions;
+      loop();
+      if (bus.transactions != before) dumpFrame(bus.gdram, frame++);
+      host::advance(1000);  // loop() spins; 1 ms per pass is plenty for 10 ms tasks
+                            // (and is what a standby wake is charged as active)
+    }
+    double wall = nowNs() - t0;
+#ifdef PLAYBOX_PROFILE
+    profDump();
+#endif
+    printf("virtual %lu ms in %.1f ms host time, %u flushes, %llu I2C bytes\n",
+           loopMs, wall / 1e6, frame, (unsigned long long)bus.bytesSent);
+    printf("ntp: %u syncs, %u timeouts, drift %+d ppm, next in %lu s\n", timeClient.syncs, timeClient.timeouts,
+           timeClient.driftPpm(), (unsigned long)timeClient.intervalMs() / 1000);
+    printf("standby: %llu ms in light sleep over %u sleeps, %u full minutes\n",
+           (unsigned long long)(host::sleptUs / 1000), host::sleeps, standbyStats.minutes);
+    if (standbyStats.minutes)
+      printf("  last minute: %lu us active (%.3f%% duty), %lu wakes\n",
+             (unsigned long)standbyStats.lastActiveUs, standbyStats.lastActiveUs / (STANDBY_WINDOW_MS * 10.0),
+             (unsigned long)standbyStats.lastWakes);
+    printf("temp: %lu samples, %lu day and %lu week buckets, %u Preferences writes\n",
+           (unsigned long)tempHist.rawTotal, (unsigned long)tempHist.day.total, (unsigned long)tempHist.week.total,
+           Preferences::writes);
+    if (buttonEventsDropped) printf("buttons: %u events found the queue full\n", buttonEventsDropped);
+    return 0;
+  }
+
+  const Game *game = findGame(gameName);
+  if (!game) return usage();
+
+  if (replayPath) replayPlay();
+  else if (recordPath) replayRecord(gameName, seed);
+  else gameSeed(seed);
+  gameClock = 0;
+  game->init();
+  double updateNs = 0, renderNs = 0;
+  uint32_t restarts = 0;
+  uint64_t bytes0 = bus.bytesSent;
+  for (uint32_t f = 0; f < frames; f++) {
+    applyScript();
+    replayStep(gameClock);
+    double t0 = nowNs();
+    {
+      PROF_SCOPE(PROF_UPDATE);
+      game->update();
+    }
+    double t1 = nowNs();
+    gameClock += game->stepMs;
+    host::advance(game->stepMs * 1000ULL);
+    if (game->finished()) {
+      game->init();
+      restarts++;
+      continue;
+    }
+    {
+      PROF_SCOPE(PROF_RENDER);
+      game->render();
+    }
+    double t2 = nowNs();
+    updateNs += t1 - t0;
+    renderNs += t2 - t1;
+    dumpFrame(bus.gdram, f);
+    PROF_POLL();
+  }
+#ifdef PLAYBOX_PROFILE
+  profDump();
+#endif
+
+  printf("%s: %lu frames, %u restarts\n", gameName, frames, restarts);
+  printf("  update %8.0f ns/frame\n", updateNs / frames);
+  printf("  render %8.0f ns/frame (incl. flush)\n", renderNs / frames);
+  printf("  i2c    %8.1f bytes/frame\n", (bus.bytesSent - bytes0) / (double)frames);
+  if (dumpDir) printf("  dumped %u frames to %s\n", dumped, dumpDir);
+  if (game == &attractGame)
+    printf("  bot    %u plans, %u detours, length %d\n", botPlans, botDetours, snakeLength);
+
+  bool ok = replayStop(display.getBuffer(), FLUSH_BYTES);
+  if (recordPath) {
+    FILE *f = fopen(recordPath, "wb");
+    if (!f || fwrite(&replayLog, 1, replayBytes(), f) != replayBytes()) { perror(recordPath); return 1; }
+    fclose(f);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Runs WifiLink.h against the mock WiFi layer in host/WiFi.h, which charges
+// virtual time for scans, association and DHCP, through the cases the
+// credential store is for: first provisioning, reboots on the cached AP and
+// lease, lease renewal, an AP that moved channel, several networks with
+// different connect times, a bad password and store eviction.
+//
+//   g++ -std=c++17 -O2 -I host -I Play_Box -o wifi_connect host/wifi_connect.cpp host/host.cpp
+//   ./wifi_connect [--scan-ms 2000] [--dhcp-ms 1200] [--assoc-ms 300]
+//
+// Each line shows how the link came up and what it cost; the exit status is
+// 1 if any case didn't go the way the store is meant to make it go.
+
+#include <Arduino.h>
+#include "WifiLink.h"
+
+namespace {
+
+Preferences prefs;
+int failures = 0;
+
+struct Outcome {
+  bool up;
+  unsigned long ms;
+  uint32_t scans, dhcps;
+};
+
+// What a power cycle leaves: the store in Preferences, nothing in RAM
+void reboot() {
+  WiFi.disconnect();
+  wifiState = WIFI_IDLE;
+  wifiNet = nullptr;
+  wifiFresh = false;
+  memset(&wifiStore, 0, sizeof(wifiStore));
+  wifiStoreLoad(prefs);
+}
+
+// Runs `start`, then polls like wifiTask does until the link is up or an
+// attempt has failed (a later one, if it was already FAILED)
+template <typename F>
+Outcome settle(F start, unsigned long limitMs = 30000) {
+  uint32_t scans0 = WiFi.scans, dhcps0 = WiFi.dhcps;
+  unsigned long t0 = millis();
+  start();
+  bool tried = wifiState != WIFI_FAILED;
+  while (millis() - t0 < limitMs) {
+    host::advance(100000);
+    wifiPoll();
+    tried |= wifiState != WIFI_FAILED;
+    if (wifiState == WIFI_CONNECTED || (wifiState == WIFI_FAILED && tried)) break;
+  }
+  return { wifiState == WIFI_CONNECTED, millis() - t0, WiFi.scans - scans0, WiFi.dhcps - dhcps0 };
+}
+
+// A power cycle, then the boot-time wifiStart()
+Outcome boot() {
+  return settle([] {
+    reboot();
+    wifiStart();
+  });
+}
+
+void report(const char *name, const Outcome &o, bool ok) {
+  printf("%-34s %-6s %6lu ms  %u scans  %u DHCP  %-9s %s\n", name, o.up ? "up" : "failed", o.ms, o.scans, o.dhcps,
+         o.up && wifiNet ? wifiNet->ssid : "-", ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+WiFiClass::AccessPoint &ap(const char *ssid) {
+  for (auto &a : WiFi.aps)
+    if (a.ssid == ssid) return a;
+  WiFi.aps.push_back({ ssid, "", { 0x02, 0, 0, 0, 0, (uint8_t)(WiFi.aps.size() + 1) }, 1, -60, false, 0 });
+  return WiFi.aps.back();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char *a = argv[i], *v = argv[i + 1];
+    if (!strcmp(a, "--scan-ms")) WiFi.scanMs = atoi(v);
+    else if (!strcmp(a, "--dhcp-ms")) WiFi.dhcpMs = atoi(v);
+    else if (!strcmp(a, "--assoc-ms")) WiFi.assocMs = atoi(v);
+    else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+  }
+  Serial.enabled = false;
+  prefs.begin("wifi", false);
+  wifiOnSave = [] { wifiStoreSave(prefs); };
+
+  // home: the default AP; office: a second known network whose AP is busy
+  ap("home").pass = "secret";
+  WiFiClass::AccessPoint &office = ap("office");
+  office.pass = "hunter2";
+  office.channel = 11;
+  office.slowMs = 900;
+
+  Outcome o;
+  wifiStoreLoad(prefs);
+  report("nothing saved", { false, 0, 0, 0 }, !wifiStart());
+
+  o = settle([] { wifiAdd("home", "secret"); });
+  report("provision home", o, o.up && o.scans == 1 && o.dhcps == 1);
+
+  o = boot();
+  report("reboot: cached AP and lease", o, o.up && !o.scans && !o.dhcps);
+
+  for (int i = 1; i < WIFI_LEASE_REUSES; i++) boot();
+  o = boot();
+  report("reboot: lease due for renewal", o, o.up && !o.scans && o.dhcps == 1);
+
+  o = settle([] { WiFi.drop(); });
+  report("link lost, AP still there", o, o.up && !o.scans);
+
+  ap("home").channel = 1;
+  o = boot();
+  report("reboot: AP moved to channel 1", o, o.up && o.scans == 1 && WiFi.channel() == 1);
+  o = boot();
+  report("reboot: new channel cached", o, o.up && !o.scans);
+
+  office.on = true;
+  o = settle([] { wifiAdd("office", "wrong"); });
+  report("provision office, bad password", o, !o.up && wifiStore.count == 1);
+  o = settle([] {}, WIFI_RETRY_MIN_MS + 10000);
+  report("  retry goes back to home", o, o.up && !strcmp(wifiNet->ssid, "home"));
+
+  o = settle([] { wifiAdd("office", "hunter2"); });
+  report("provision office", o, o.up && wifiStore.count == 2);
+
+  // Both known: the faster one is tried first whatever was used last
+  o = boot();
+  report("reboot: fastest known first", o, o.up && !strcmp(wifiNet->ssid, "home"));
+
+  ap("home").on = false;
+  o = boot();
+  report("reboot: home gone, office found", o, o.up && o.scans == 1 && !strcmp(wifiNet->ssid, "office"));
+  ap("home").on = true;
+
+  office.on = false;
+  ap("home").on = false;
+  o = boot();
+  report("reboot: nothing in range", o, !o.up);
+  ap("home").on = true;
+  o = settle([] {}, WIFI_RETRY_MAX_MS);
+  report("  backoff retry finds home", o, o.up && !strcmp(wifiNet->ssid, "home"));
+
+  // Two more fill the store; a fifth replaces the least recently used
+  const char *extra[] = { "cafe", "library", "hotspot" };
+  for (const char *name : extra) {
+    ap(name).on = true;
+    settle([name] { wifiAdd(name, ""); });
+    ap(name).on = false;
+  }
+  ap("home").on = true;
+  bool evicted = wifiStore.count == WIFI_MAX_NETWORKS && !wifiFind("office") && wifiFind("hotspot");
+  report("fifth network evicts the oldest", { true, 0, 0, 0 }, evicted);
+
+  printf("\nstore (%u networks):\n", wifiStore.count);
+  for (int i = 0; i < wifiStore.count; i++) {
+    const WifiNetwork &n = wifiStore.net[i];
+    printf("  %-8s ch %2u  lease %-15s x%u  %u connects, %u fails, avg %lu ms, last %lu ms\n", n.ssid, n.channel,
+           IPAddress(n.ip).toString().c_str(), n.leaseUses, n.connects, n.fails, (unsigned long)n.avgMs,
+           (unsigned long)n.lastMs);
+  }
+  printf("%u Preferences writes\n", Preferences::writes);
+  if (failures) printf("%d case(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -1,5 +1,4 @@
 #include <WiFi.h>
-#include <NTPClient.h>
 #include <WiFiUdp.h>
 #include <Wire.h>
 #include <Adafruit_SSD1306.h>
@@ -13,6 +12,11 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
+#include "Play_Box/PlayDisplay.h"
+#include "Play_Box/ClockFace.h"
+#include "Play_Box/NtpSync.h"
+#include "Play_Box/WifiLink.h"
+
 #define OLED_RESET     -1
 #define SCREEN_WIDTH   128
 #define SCREEN_HEIGHT  32
@@ -25,11 +29,11 @@
 #define BTN_DOWN       7
 #define BTN_MENU       8
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+PlayDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 OneWire oneWire(TEMP_PIN);
 DallasTemperature sensors(&oneWire);
 WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, "pool.ntp.org", 19800); // IST
+AsyncNtp timeClient(ntpUDP, "pool.ntp.org", 19800); // IST
 Preferences preferences;
 
 BLECharacteristic *pSSID;
@@ -71,49 +75,55 @@ void setupBLE() {
   pAdvertising->start();
 }
 
+void saveWiFi(const String &ssid, const String &pass) {
+  preferences.putString("ssid", ssid);
+  preferences.putString("pass", pass);
+}
+
+void wifiChanged(WifiState state) {
+  if (state == WIFI_CONNECTED) timeClient.begin();
+  else timeClient.end();
+}
+
 void connectWiFi() {
   String savedSSID = preferences.getString("ssid", "");
   String savedPASS = preferences.getString("pass", "");
-  if (savedSSID != "") {
-    WiFi.begin(savedSSID.c_str(), savedPASS.c_str());
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
-      delay(100);
-  }
+  if (savedSSID != "") wifiConnect(savedSSID, savedPASS, false);
 }
 
 void drawClock() {
   sensors.requestTemperatures();
   float tempC = sensors.getTempCByIndex(0);
 
-  display.clearDisplay();
-  display.setTextColor(SSD1306_WHITE);
-  display.setFont(&FreeSans9pt7b);
-  display.setCursor(0, 15);
-
-  String timeStr = timeClient.getFormattedTime();
-  int hour = timeStr.substring(0, 2).toInt();
-  String ampm = "AM";
-  if (hour >= 12) { ampm = "PM"; if (hour > 12) hour -= 12; }
-  if (hour == 0) hour = 12;
-  timeStr = (hour < 10 ? " " : "") + String(hour) + timeStr.substring(2) + " " + ampm;
-  display.print(timeStr);
-
-  display.setFont();
-  display.setCursor(0, 24);
-  time_t rawTime = timeClient.getEpochTime();
-  struct tm *ti = localtime(&rawTime);
-  char dateBuf[20];
-  strftime(dateBuf, sizeof(dateBuf), "%d %b (%a)", ti);
-  display.print(dateBuf);
+  unsigned long epoch = timeClient.getEpochTime();
+  int hour = (epoch % 86400L) / 3600;
+  int h12 = hour % 12;
+  if (h12 == 0) h12 = 12;
+  char timeBuf[CLOCK_TEXT_MAX];
+  snprintf(timeBuf, sizeof(timeBuf), "%2d:%02d:%02d %s", h12, (int)(epoch % 3600) / 60,
+           (int)(epoch % 60), hour >= 12 ? "PM" : "AM");
+  clockFaceTime(display, timeBuf);
+
+  // Date text only changes at midnight
+  static long shownDay = -1;
+  static char dateBuf[20];
+  if ((long)(epoch / 86400L) != shownDay) {
+    time_t rawTime = epoch;
+    strftime(dateBuf, sizeof(dateBuf), "%d %b (%a)", localtime(&rawTime));
+    shownDay = epoch / 86400L;
+  }
+  clockFaceDate(display, dateBuf);
 
-  display.setCursor(90, 24);
-  display.print(String(tempC, 1) + "C");
+  char tempBuf[12];
+  snprintf(tempBuf, sizeof(tempBuf), "%.1fC", tempC);
+  clockFaceTemp(display, tempBuf);
+  clockFaceDone(display);
 
   display.display();
 }
 
 void drawMenu() {
+  clockFaceInvalidate();
   display.clearDisplay();
   display.setFont();
   display.setTextSize(1);
@@ -160,18 +170,16 @@ void setup() {
   Serial.begin(115200);
   Wire.begin(SDA_PIN, SCL_PIN);
   display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
-  display.clearDisplay(); display.display();
+  clockFaceBegin(display, 15, 90);
+  display.display();
 
   sensors.begin();
   preferences.begin("wifi", false);
   setupBLE();
+  wifiOnChange = wifiChanged;
+  wifiOnSave = saveWiFi;
   connectWiFi();
 
-  if (WiFi.status() == WL_CONNECTED) {
-    timeClient.begin();
-    timeClient.update();
-  }
-
   pinMode(BTN_SELECT, INPUT);
   pinMode(BTN_UP, INPUT);
   pinMode(BTN_DOWN, INPUT);
@@ -182,19 +190,12 @@ void setup() {
 
 void loop() {
   if (newCredsReceived) {
-    WiFi.begin(ssidReceived.c_str(), passReceived.c_str());
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
-      delay(100);
-    if (WiFi.status() == WL_CONNECTED) {
-      preferences.putString("ssid", ssidReceived);
-      preferences.putString("pass", passReceived);
-      timeClient.begin();
-    }
     newCredsReceived = false;
+    wifiConnect(ssidReceived, passReceived, true);
   }
 
-  if (WiFi.status() == WL_CONNECTED) timeClient.update();
+  wifiPoll();
+  if (wifiState == WIFI_CONNECTED) timeClient.update();
 
   if (inClockScreen) {
     drawClock();